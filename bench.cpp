@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "Card.h"
+#include "CardSet.hpp"
+#include "Context.h"
+#include "Deck.h"
+#include "Endgame.h"
+#include "Engine.h"
+#include "Event.hpp"
+#include "GameLog.h"
+#include "GameState.h"
+#include "Hand.h"
+#include "Player.h"
+#include "PlayersGroup.h"
+#include "Random.hpp"
+#include "Round.h"
+#include "Sampler.h"
+#include "Settings.h"
+#include "Utility.hpp"
+
+namespace
+{
+	std::atomic<size_t> g_allocationsCount = 0;
+
+	void* allocate(size_t size)
+	{
+		g_allocationsCount.fetch_add(1, std::memory_order_relaxed);
+		if (void* ptr = std::malloc(size ? size : 1))
+			return ptr;
+		throw std::bad_alloc();
+	}
+
+	void* allocate(size_t size, std::align_val_t alignment)
+	{
+		g_allocationsCount.fetch_add(1, std::memory_order_relaxed);
+		const auto align = static_cast<size_t>(alignment);
+		size = (std::max<size_t>(size, 1) + align - 1) & ~(align - 1); // aligned_alloc wants a multiple of the alignment
+#ifdef _WIN32
+		if (void* ptr = _aligned_malloc(size, align))
+#else
+		if (void* ptr = std::aligned_alloc(align, size))
+#endif
+			return ptr;
+		throw std::bad_alloc();
+	}
+
+	void deallocate(void* ptr, std::align_val_t)
+	{
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+}
+
+// every form is replaced, so the allocations are all counted and freed by the matching function
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { deallocate(ptr, alignment); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { deallocate(ptr, alignment); }
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept { deallocate(ptr, alignment); }
+void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept { deallocate(ptr, alignment); }
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr Random::Seed Seed = 1;
+	constexpr auto MinBatchTime = std::chrono::milliseconds(20);
+	constexpr size_t RepetitionsCount = 5;
+	constexpr size_t CallsPerBatch = 64;
+
+	volatile size_t g_sink = 0;
+
+	struct Measurement
+	{
+		std::string name;
+		size_t opsCount = 0;
+		double nsPerOp = 0.;
+		double allocationsPerOp = 0.;
+	};
+
+	class Bench final
+	{
+	public:
+		explicit Bench(const char* filter)
+			: _filter(filter)
+		{}
+
+		// prepare() builds the input of one batch untimed, body(input) does opsPerBatch operations on it
+		template<typename Prepare, typename Body>
+		void Run(const char* name, size_t opsPerBatch, const Prepare& prepare, const Body& body)
+		{
+			if (_filter && !std::strstr(name, _filter))
+				return;
+
+			size_t batchesCount = 1;
+			while (measure(batchesCount, prepare, body).first < MinBatchTime && batchesCount < (size_t{ 1 } << 30))
+				batchesCount *= 2;
+
+			Measurement measurement{ name, batchesCount * opsPerBatch };
+			for (size_t i = 0; i < RepetitionsCount; ++i)
+			{
+				const auto [time, allocationsCount] = measure(batchesCount, prepare, body);
+				const double nsPerOp = std::chrono::duration<double, std::nano>(time).count() / measurement.opsCount;
+				if (i == 0 || nsPerOp < measurement.nsPerOp)
+					measurement.nsPerOp = nsPerOp;
+				measurement.allocationsPerOp = static_cast<double>(allocationsCount) / measurement.opsCount;
+			}
+			_measurements.push_back(measurement);
+		}
+
+		// without per batch input several calls make a batch, so that reading the clock doesn't dominate
+		template<typename Body>
+		void Run(const char* name, size_t opsPerCall, const Body& body)
+		{
+			Run(name, opsPerCall * CallsPerBatch, []() { return 0; }, [&body](int)
+				{
+					size_t result = 0;
+					for (size_t i = 0; i < CallsPerBatch; ++i)
+						result += body();
+					return result;
+				});
+		}
+
+		void Print(std::ostream& stream) const
+		{
+			stream << "{\n\t\"benchmarks\": [";
+			for (size_t i = 0; i < _measurements.size(); ++i)
+			{
+				const auto& measurement = _measurements[i];
+				stream << (i ? ",\n" : "\n")
+					<< "\t\t{ \"name\": \"" << measurement.name << "\""
+					<< ", \"ops\": " << measurement.opsCount
+					<< ", \"ns_per_op\": " << measurement.nsPerOp
+					<< ", \"allocations_per_op\": " << measurement.allocationsPerOp << " }";
+			}
+			stream << "\n\t]\n}" << std::endl;
+		}
+
+	private:
+		template<typename Prepare, typename Body>
+		static std::pair<Clock::duration, size_t> measure(size_t batchesCount, const Prepare& prepare, const Body& body)
+		{
+			Clock::duration time{};
+			size_t allocationsCount = 0;
+			for (size_t i = 0; i < batchesCount; ++i)
+			{
+				auto input = prepare();
+				const size_t allocationsBefore = g_allocationsCount.load(std::memory_order_relaxed);
+				const auto start = Clock::now();
+				g_sink = g_sink + body(input);
+				time += Clock::now() - start;
+				allocationsCount += g_allocationsCount.load(std::memory_order_relaxed) - allocationsBefore;
+			}
+			return { time, allocationsCount };
+		}
+
+	private:
+		const char* _filter = nullptr;
+		std::vector<Measurement> _measurements;
+	};
+
+	inline std::vector<Card> makeCards(size_t count, Random::Generator& random)
+	{
+		std::vector<Card> cards;
+		cards.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+			cards.push_back(CardSet::GetCard(Random::GetNumber(random, CardSet::MaxCount - 1)));
+		return cards;
+	}
+
+	inline Settings makeSettings(Settings::Difficulty difficulty, size_t botsNumber)
+	{
+		Settings settings;
+		settings.difficulty = difficulty;
+		settings.botsNumber = botsNumber;
+		settings.withUser = false;
+		settings.botDelay = {};
+		settings.pauseDelay = {};
+		settings.botThinkTime = {};
+		settings.botSearchIterations = 100;
+		settings.botSearchThreadsCount = 1;
+		settings.seed = Seed;
+		return settings;
+	}
+
+	struct CardHash
+	{
+		size_t operator()(const Card& card) const { return CardSet::GetIndex(card); }
+	};
+
+	void runCardBenchmarks(Bench& bench)
+	{
+		constexpr size_t count = 1024;
+		auto random = Random::MakeGenerator(Seed);
+		const auto cards = makeCards(count + 1, random);
+
+		bench.Run("card_beats", count, [&cards]()
+			{
+				size_t result = 0;
+				for (size_t i = 0; i < count; ++i)
+					result += cards[i].Beats(cards[i + 1], Card::Suit::Spades);
+				return result;
+			});
+
+		bench.Run("card_less", count, [&cards]()
+			{
+				size_t result = 0;
+				for (size_t i = 0; i < count; ++i)
+					result += cards[i] < cards[i + 1];
+				return result;
+			});
+
+		bench.Run("cardset_beating", count, [&cards]()
+			{
+				size_t result = 0;
+				for (size_t i = 0; i < count; ++i)
+					result += CardSet::Beating(cards[i], Card::Suit::Spades).GetCount();
+				return result;
+			});
+	}
+
+	void runHandBenchmarks(Bench& bench)
+	{
+		auto random = Random::MakeGenerator(Seed);
+		const Deck deck(random);
+		const auto& cards = deck.GetCards();
+
+		bench.Run("hand_add_remove_card", 2 * cards.size(), [&cards]()
+			{
+				Hand hand;
+				for (const Card& card : cards)
+					hand.AddCard(card);
+				for (const Card& card : cards)
+					hand.RemoveCard(card);
+				return hand.GetCardCount();
+			});
+
+		Hand hand;
+		for (size_t i = 0; i < Hand::MinCount; ++i)
+			hand.AddCard(cards[i]);
+
+		bench.Run("hand_for_each_card", 1, [&hand]()
+			{
+				size_t result = 0;
+				hand.ForEachCard([&result](const Card& card)
+					{
+						result += static_cast<size_t>(card.GetRank());
+						return false;
+					});
+				return result;
+			});
+	}
+
+	void runDeckBenchmarks(Bench& bench)
+	{
+		constexpr size_t decksCount = 64;
+		auto random = Random::MakeGenerator(Seed);
+
+		bench.Run("deck_construct", 1, [&random]()
+			{
+				const Deck deck(random);
+				return deck.GetCount();
+			});
+
+		bench.Run("deck_pop_first", decksCount * Deck::GetMaxCount(), [&random]()
+			{
+				std::vector<Deck> decks;
+				decks.reserve(decksCount);
+				for (size_t i = 0; i < decksCount; ++i)
+					decks.emplace_back(random);
+				return decks;
+			}, [](std::vector<Deck>& decks)
+			{
+				size_t result = 0;
+				for (Deck& deck : decks)
+				{
+					while (const auto card = deck.PopFirst())
+						result += static_cast<size_t>(card->GetRank());
+				}
+				return result;
+			});
+	}
+
+	void runUtilityBenchmarks(Bench& bench)
+	{
+		auto random = Random::MakeGenerator(Seed);
+		const Deck deck(random);
+		const auto& cards = deck.GetCards();
+		using CardList = utility::mapped_list<Card, size_t, CardHash>;
+
+		bench.Run("mapped_list_push_erase", 2 * cards.size(), [&cards]()
+			{
+				CardList list;
+				for (const Card& card : cards)
+					list.push_back(card, CardSet::GetIndex(card));
+				for (const Card& card : cards)
+					list.erase(card);
+				return list.size();
+			});
+
+		CardList list;
+		for (const Card& card : cards)
+			list.push_back(card, CardSet::GetIndex(card));
+
+		bench.Run("mapped_list_at", cards.size(), [&cards, &list]()
+			{
+				size_t result = 0;
+				for (const Card& card : cards)
+					result += list.at(card);
+				return result;
+			});
+
+		bench.Run("mapped_list_index_of", cards.size(), [&cards, &list]()
+			{
+				size_t result = 0;
+				for (const Card& card : cards)
+					result += list.index_of(card);
+				return result;
+			});
+
+		constexpr size_t keysCount = 1024;
+		std::vector<uint64_t> keys(keysCount);
+		for (uint64_t& key : keys)
+			key = Random::MakeSeed(Seed, random());
+
+		utility::transposition_table<uint32_t> table(1 << 16);
+		bench.Run("transposition_table_store_find", 2 * keysCount, [&keys, &table]()
+			{
+				size_t result = 0;
+				for (const uint64_t key : keys)
+					table.store(key, static_cast<uint32_t>(key));
+				for (const uint64_t key : keys)
+					result += table.find(key).value_or(0);
+				return result;
+			});
+	}
+
+	void runPlayersBenchmarks(Bench& bench)
+	{
+		Context context;
+		context.Setup(makeSettings(Settings::Difficulty::Medium, 4));
+		auto& players = context.GetPlayers();
+		const Player* attacker = players.GetFirst();
+
+		bench.Run("players_for_each_attack_player", 1, [&players, attacker]()
+			{
+				size_t result = 0;
+				players.ForEachAttackPlayer([&result](Player* player)
+					{
+						result += player->GetId();
+						return false;
+					}, attacker);
+				return result;
+			});
+
+		constexpr size_t stepsCount = 1024;
+
+		bench.Run("players_next", stepsCount, [&players, attacker]()
+			{
+				const Player* player = attacker;
+				for (size_t i = 0; i < stepsCount; ++i)
+					player = &players.Next(*player);
+				return static_cast<size_t>(player->GetId());
+			});
+
+		bench.Run("players_previous", stepsCount, [&players, attacker]()
+			{
+				const Player* player = attacker;
+				for (size_t i = 0; i < stepsCount; ++i)
+					player = &players.Previous(*player);
+				return static_cast<size_t>(player->GetId());
+			});
+	}
+
+	void runBotBenchmarks(Bench& bench)
+	{
+		{
+			Context context;
+			context.Setup(makeSettings(Settings::Difficulty::Medium, 2));
+			Player& attacker = *context.GetPlayers().GetFirst();
+			const Player& defender = context.GetPlayers().Next(attacker);
+
+			bench.Run("bot_medium_attack", 1, [&]()
+				{
+					const auto card = attacker.Attack(context, defender, CardSet::All());
+					if (!card)
+						return size_t{ 0 };
+
+					attacker.GetHand().AddCard(*card);
+					return CardSet::GetIndex(*card);
+				});
+		}
+
+		{
+			// the hard bots' Memory is the only handler of these events
+			Context context;
+			context.Setup(makeSettings(Settings::Difficulty::Hard, 3));
+			Player& attacker = *context.GetPlayers().GetFirst();
+			Player& defender = context.GetPlayers().Next(attacker);
+			const Round round(attacker, defender);
+			const CardSet cards = attacker.GetHand().GetCards();
+			auto& events = context.GetEvents();
+
+			bench.Run("memory_events", 3, [&]()
+				{
+					events.OnPlayerAttack(attacker, *cards.GetLowest());
+					events.OnPlayerDrawRoundCards(defender, cards);
+					events.OnRoundEnd(round);
+					return cards.GetCount();
+				});
+		}
+	}
+
+	void runGameBenchmarks(Bench& bench)
+	{
+		auto random = Random::MakeGenerator(Seed);
+		const Deck deck(random);
+		GameState state(deck, 3);
+		state.Start(0);
+
+		bench.Run("game_state_apply_undo", 1, [&state]()
+			{
+				GameState copy = state;
+				const auto card = copy.GetPlayableCards().GetLowest();
+				const auto undo = copy.ApplyMove(card ? GameState::Move::Play(*card) : GameState::Move::Pass());
+				copy.UndoMove(undo);
+				return copy.GetDeckCount();
+			});
+
+		// a deal for the first player with a few cards known and a suit ruled out for the second one
+		Sampler::Beliefs beliefs;
+		beliefs[1].knownCards = CardSet(state.GetHand(1).GetMask() & CardSet::OfSuit(state.GetTrumpSuit()).GetMask());
+		beliefs[2].impossibleCards = CardSet::OfSuit(Card::Suit::Spades) - state.GetHand(2);
+		const Sampler sampler(state, beliefs);
+		auto dealRandom = Random::MakeGenerator(Seed);
+		GameState deal = state;
+
+		bench.Run("sampler_deal", 1, [&sampler, &dealRandom, &deal]()
+			{
+				sampler.Deal(deal, dealRandom);
+				return deal.GetHand(1).GetMask();
+			});
+
+		// first decision after the deck runs out, with the table as empty as at the start of a game
+		GameState endgame(deck, 2);
+		endgame.Start(0);
+		while (endgame.GetPhase() != GameState::Phase::Over && !Endgame::IsSolvable(endgame))
+		{
+			const auto card = endgame.GetPlayableCards().GetLowest();
+			endgame.ApplyMove(card ? GameState::Move::Play(*card) : endgame.GetMove(GameState::NoCardMove));
+		}
+
+		bench.Run("endgame_solve", 1, []() { return Endgame(); }, [&endgame](Endgame& solver)
+			{
+				const auto solution = solver.Solve(endgame);
+				return solution ? static_cast<size_t>(solution->result) + 1 : size_t{ 0 };
+			});
+
+		Random::Seed seed = Seed;
+		bench.Run("game_medium_3_bots", 1, [&seed]()
+			{
+				Settings settings = makeSettings(Settings::Difficulty::Medium, 3);
+				settings.seed = Random::MakeSeed(Seed, seed++);
+
+				Context context;
+				context.Setup(settings);
+				return Engine::Run(context, 1000).roundsCount;
+			});
+
+		// a log of a few recorded games, read back the way an analysis would
+		constexpr size_t logGamesCount = 64;
+		const auto logPath = std::filesystem::temp_directory_path() / "durak_bench.log";
+		std::filesystem::remove(logPath);
+		{
+			GameLog log(logPath);
+			GameLog::Batch batch(log);
+			for (size_t i = 0; i < logGamesCount; ++i)
+			{
+				Settings settings = makeSettings(Settings::Difficulty::Easy, 3);
+				settings.seed = Random::MakeSeed(Seed, i);
+
+				Context context;
+				GameLog::Recorder recorder(batch, context, settings);
+				context.Setup(settings);
+				Engine::Run(context, 1000);
+			}
+		}
+
+		{
+			const GameLog::Reader reader(logPath);
+			bench.Run("game_log_read", logGamesCount, [&reader]()
+				{
+					size_t cards = 0;
+					reader.ForEachGame([&cards](const GameLog::Game& game)
+						{
+							game.ForEachEvent([&cards](const GameLog::Event& event)
+								{
+									cards += event.value;
+									return false;
+								});
+							return false;
+						});
+					return cards;
+				});
+		}
+		std::filesystem::remove(logPath);
+	}
+}
+
+// durak_bench [name filter], prints JSON
+int main(int argc, char* argv[])
+{
+	Bench bench(argc > 1 ? argv[1] : nullptr);
+	runCardBenchmarks(bench);
+	runHandBenchmarks(bench);
+	runDeckBenchmarks(bench);
+	runUtilityBenchmarks(bench);
+	runPlayersBenchmarks(bench);
+	runBotBenchmarks(bench);
+	runGameBenchmarks(bench);
+	bench.Print(std::cout);
+	return 0;
+}
\ No newline at end of file
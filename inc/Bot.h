@@ -4,17 +4,19 @@
 #include "Player.h"
 #include "Settings.h"
 
+class EventHandlers;
+
 class Bot final : public Player
 {
 public:
 	class Behavior;
 
-	Bot(Id, Settings::Difficulty);
+	Bot(Id, Settings::Difficulty, const Settings&, EventHandlers&);
 	~Bot();
 
 protected:
-	std::optional<Card> pickAttackCard(const Context&, const Player& defender, const CardFilter&) const override;
-	std::optional<Card> pickDefendCard(const Context&, const Player& attacker, const CardFilter&) const override;
+	std::optional<Card> pickAttackCard(const Context&, const Player& defender, const CardSet& playableCards) const override;
+	std::optional<Card> pickDefendCard(const Context&, const Player& attacker, const CardSet& playableCards) const override;
 
 private:
 	std::unique_ptr<Behavior> _behavior;
@@ -0,0 +1,217 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <optional>
+#include <iterator>
+#include <initializer_list>
+#include "Card.h"
+
+// One bit per card of the deck. Cards are indexed rank-major,
+// so bit order matches Card::operator< and the lowest bit is the lowest card.
+class CardSet final
+{
+public:
+	using Mask = uint64_t;
+
+	static constexpr size_t SuitCount = static_cast<size_t>(Card::Suit::Count);
+	static constexpr size_t RankCount = static_cast<size_t>(Card::Rank::Max) - static_cast<size_t>(Card::Rank::Min) + 1;
+	static constexpr size_t MaxCount = SuitCount * RankCount;
+
+	class Iterator final
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Card;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = Card;
+
+		constexpr Iterator() = default;
+		constexpr explicit Iterator(Mask mask)
+			: _mask(mask)
+		{}
+
+		Card operator*() const { return GetCard(static_cast<size_t>(std::countr_zero(_mask))); }
+		constexpr Iterator& operator++() { _mask &= _mask - 1; return *this; }
+		constexpr Iterator operator++(int) { Iterator tmp = *this; ++*this; return tmp; }
+		constexpr bool operator==(const Iterator&) const = default;
+
+	private:
+		Mask _mask = 0;
+	};
+
+	constexpr CardSet() = default;
+	constexpr explicit CardSet(Mask mask)
+		: _mask(mask & FullMask)
+	{}
+
+	CardSet(std::initializer_list<Card> cards)
+	{
+		for (const Card& card : cards)
+			Add(card);
+	}
+
+	static constexpr size_t GetIndex(Card::Suit suit, Card::Rank rank)
+	{
+		return (static_cast<size_t>(rank) - static_cast<size_t>(Card::Rank::Min)) * SuitCount + static_cast<size_t>(suit);
+	}
+
+	static size_t GetIndex(const Card& card)
+	{
+		return GetIndex(card.GetSuit(), card.GetRank());
+	}
+
+	static Card GetCard(size_t index)
+	{
+		return { static_cast<Card::Suit>(index % SuitCount), static_cast<Card::Rank>(index / SuitCount + static_cast<size_t>(Card::Rank::Min)) };
+	}
+
+	static constexpr CardSet All()
+	{
+		return CardSet(FullMask);
+	}
+
+	static CardSet Of(const Card& card)
+	{
+		return CardSet(Mask{ 1 } << GetIndex(card));
+	}
+
+	static constexpr CardSet OfSuit(Card::Suit suit)
+	{
+		return CardSet(SuitMask << static_cast<size_t>(suit));
+	}
+
+	static constexpr CardSet OfRank(Card::Rank rank)
+	{
+		return CardSet(RankMask << GetIndex(Card::Suit{}, rank));
+	}
+
+	// all cards that beat the card, AND it with a hand to get the cards that can defend
+	static CardSet Beating(const Card& card, Card::Suit trumpSuit)
+	{
+		return CardSet(BeatingMasks[static_cast<size_t>(trumpSuit)][GetIndex(card)]);
+	}
+
+	constexpr Mask GetMask() const { return _mask; }
+	constexpr bool IsEmpty() const { return _mask == 0; }
+	constexpr size_t GetCount() const { return static_cast<size_t>(std::popcount(_mask)); }
+
+	bool Contains(const Card& card) const
+	{
+		return (_mask & Of(card)._mask) != 0;
+	}
+
+	constexpr bool Contains(const CardSet& other) const
+	{
+		return (_mask & other._mask) == other._mask;
+	}
+
+	constexpr bool Intersects(const CardSet& other) const
+	{
+		return (_mask & other._mask) != 0;
+	}
+
+	CardSet& Add(const Card& card) { _mask |= Of(card)._mask; return *this; }
+	constexpr CardSet& Add(const CardSet& other) { _mask |= other._mask; return *this; }
+	CardSet& Remove(const Card& card) { _mask &= ~Of(card)._mask; return *this; }
+	constexpr CardSet& Remove(const CardSet& other) { _mask &= ~other._mask; return *this; }
+	constexpr void Clear() { _mask = 0; }
+
+	std::optional<Card> GetLowest() const
+	{
+		if (IsEmpty())
+			return std::nullopt;
+		return GetCard(static_cast<size_t>(std::countr_zero(_mask)));
+	}
+
+	std::optional<Card> GetHighest() const
+	{
+		if (IsEmpty())
+			return std::nullopt;
+		return GetCard(static_cast<size_t>(std::bit_width(_mask) - 1));
+	}
+
+	// i-th card in ascending order
+	std::optional<Card> GetNth(size_t i) const
+	{
+		Mask mask = _mask;
+		for (; i > 0 && mask; --i)
+			mask &= mask - 1;
+
+		if (!mask)
+			return std::nullopt;
+		return GetCard(static_cast<size_t>(std::countr_zero(mask)));
+	}
+
+	constexpr CardSet GetSuit(Card::Suit suit) const
+	{
+		return *this & OfSuit(suit);
+	}
+
+	constexpr CardSet GetRank(Card::Rank rank) const
+	{
+		return *this & OfRank(rank);
+	}
+
+	// all cards of the ranks present in the set
+	constexpr CardSet GetRanks() const
+	{
+		const Mask ranks = (_mask | (_mask >> 1) | (_mask >> 2) | (_mask >> 3)) & RankLowMask;
+		return CardSet(ranks * RankMask);
+	}
+
+	template<typename F>
+	bool ForEach(const F& callback) const
+	{
+		for (const Card card : *this)
+		{
+			if (callback(card))
+				return true;
+		}
+		return false;
+	}
+
+	constexpr Iterator begin() const { return Iterator(_mask); }
+	constexpr Iterator end() const { return Iterator(); }
+
+	constexpr bool operator==(const CardSet&) const = default;
+
+	constexpr CardSet operator|(const CardSet& other) const { return CardSet(_mask | other._mask); }
+	constexpr CardSet operator&(const CardSet& other) const { return CardSet(_mask & other._mask); }
+	constexpr CardSet operator^(const CardSet& other) const { return CardSet(_mask ^ other._mask); }
+	constexpr CardSet operator-(const CardSet& other) const { return CardSet(_mask & ~other._mask); }
+	constexpr CardSet operator~() const { return CardSet(~_mask); }
+
+	constexpr CardSet& operator|=(const CardSet& other) { _mask |= other._mask; return *this; }
+	constexpr CardSet& operator&=(const CardSet& other) { _mask &= other._mask; return *this; }
+	constexpr CardSet& operator^=(const CardSet& other) { _mask ^= other._mask; return *this; }
+	constexpr CardSet& operator-=(const CardSet& other) { _mask &= ~other._mask; return *this; }
+
+private:
+	static constexpr Mask FullMask = (Mask{ 1 } << MaxCount) - 1;
+	static constexpr Mask RankMask = (Mask{ 1 } << SuitCount) - 1;
+
+	static constexpr Mask SuitMask = FullMask / RankMask; // lowest bit of every rank
+	static constexpr Mask RankLowMask = SuitMask;
+
+	using BeatingTable = std::array<std::array<Mask, MaxCount>, SuitCount>;
+	static const BeatingTable BeatingMasks; // by trump suit and card index
+
+private:
+	Mask _mask = 0;
+};
+
+inline constexpr CardSet::BeatingTable CardSet::BeatingMasks = []()
+	{
+		BeatingTable masks{};
+		for (size_t trump = 0; trump < SuitCount; ++trump)
+		{
+			for (size_t index = 0; index < MaxCount; ++index)
+			{
+				const Mask higher = ~((Mask{ 2 } << index) - 1);
+				const Mask sameSuit = higher & OfSuit(static_cast<Card::Suit>(index % SuitCount)).GetMask();
+				masks[trump][index] = index % SuitCount == trump ? sameSuit : sameSuit | OfSuit(static_cast<Card::Suit>(trump)).GetMask();
+			}
+		}
+		return masks;
+	}();
\ No newline at end of file
@@ -4,9 +4,13 @@
 #include <unordered_map>
 #include <list>
 #include "Deck.h"
+#include "GameState.h"
+#include "Pacer.h"
 #include "Card.h"
+#include "Event.hpp"
+#include "Random.hpp"
 
-class UI;
+class IController;
 class PlayersGroup;
 struct Settings;
 
@@ -15,8 +19,8 @@ class Context
 public:
 	using RoundCards = std::vector<Card>;
 
-	Context() = delete;
-	Context(std::weak_ptr<UI>);
+	Context(std::weak_ptr<IController> = {});
+	~Context();
 
 	void Setup(const Settings&);
 
@@ -26,12 +30,26 @@ public:
 	PlayersGroup& GetPlayers();
 	const PlayersGroup& GetPlayers() const;
 
+	GameState& GetState();
+	const GameState& GetState() const;
+
+	Pacer& GetPacer();
+	const Pacer& GetPacer() const;
+	EventHandlers& GetEvents();
+	Random::Generator& GetRandom() const;
+	Random::Seed GetSeed() const;
+
 	Card::Suit GetTrumpSuit() const;
-	std::shared_ptr<UI> GetUI() const;
+	std::shared_ptr<IController> GetController() const;
 
 private:
+	EventHandlers _events;
+	Random::Seed _seed = 0;
+	mutable Random::Generator _random;
 	Deck _deck;
+	GameState _state;
+	Pacer _pacer;
 	std::unique_ptr<PlayersGroup> _players;
 	Card::Suit _trumpSuit;
-	std::weak_ptr<UI> _ui;
+	std::weak_ptr<IController> _controller;
 };
\ No newline at end of file
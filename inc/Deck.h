@@ -1,19 +1,22 @@
 #pragma once
 #include "Card.h"
-#include <queue>
+#include <deque>
 #include <optional>
+#include "Random.hpp"
 
 class Deck
 {
 public:
-	Deck();
+	Deck() = default;
+	explicit Deck(Random::Generator&);
 
 	bool IsEmpty() const;
 	std::optional<Card> GetLast() const;
 	std::optional<Card> PopFirst();
 	size_t GetCount() const;
+	const std::deque<Card>& GetCards() const;
 	static size_t GetMaxCount();
 
 private:
-	std::queue<Card> _queue;
+	std::deque<Card> _cards;
 };
\ No newline at end of file
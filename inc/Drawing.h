@@ -1,11 +1,14 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <optional>
 #include <SFML/System/String.hpp>
 #include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/Transformable.hpp>
 #include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 #include "Card.h"
 
 namespace sf
@@ -15,7 +18,6 @@ namespace sf
 	class RenderStates;
 	class Text;
 }
-class Deck;
 
 namespace Screen
 {
@@ -63,6 +65,39 @@ namespace Screen
 		void run(sf::RenderTarget&) const override;
 	};
 
+	// every card face and the back rendered once into a single texture
+	class CardAtlas final
+	{
+	public:
+		static const CardAtlas& Get(); // needs an active render context
+
+		const sf::Texture& GetTexture() const;
+		sf::FloatRect GetRect(const std::optional<::Card>&) const; // nullopt - the back
+
+	private:
+		CardAtlas();
+		sf::FloatRect getSlotRect(size_t column, size_t row) const;
+
+	private:
+		sf::RenderTexture _texture;
+		sf::Vector2f _cardSize;
+	};
+
+	// cards of a frame as quads of the atlas, drawn with a single call
+	class CardBatch final : public sf::Drawable
+	{
+	public:
+		void Clear();
+		void Add(const std::optional<::Card>&, const sf::Vector2f& position, float angleDegree); // nullopt - face down
+		size_t GetCount() const;
+
+	private:
+		void draw(sf::RenderTarget&, sf::RenderStates) const override;
+
+	private:
+		sf::VertexArray _vertices{ sf::PrimitiveType::Triangles }; // keeps its capacity between frames
+	};
+
 	class SkipButton final : public Drawing
 	{
 	public:
@@ -76,13 +111,14 @@ namespace Screen
 	class Deck final : public Drawing
 	{
 	public:
-		Deck(const ::Deck&);
+		Deck(size_t count, const std::optional<::Card>& trumpCard);
 
 	private:
 		void run(sf::RenderTarget&) const override;
 
 	private:
-		const ::Deck& _deck;
+		size_t _count = 0;
+		std::optional<::Card> _trumpCard; // the last one, lies face up
 	};
 
 	class Arrow final : public Drawing
@@ -105,7 +141,7 @@ namespace Screen
 		static constexpr unsigned int CharacterSize = 25;
 
 		Text() = default;
-		Text(const sf::String&);
+		Text(const sf::String&, unsigned int characterSize = CharacterSize);
 		void set(const sf::String&);
 		sf::FloatRect getLocalBounds() const;
 
@@ -116,5 +152,6 @@ namespace Screen
 
 	private:
 		sf::String _string;
+		unsigned int _characterSize = CharacterSize;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <optional>
+#include "GameState.h"
+#include "Utility.hpp"
+
+// Exact play for the end of a two player game. Once the deck is empty the cards a player can't see
+// are all in the opponent's hand, so alpha-beta can search the rest of the game to the end.
+// The transposition table is kept between calls, later moves of the same game mostly hit it.
+class Endgame final
+{
+public:
+	enum class Result : int8_t
+	{
+		Loss = -1,
+		Draw = 0,
+		Win = 1,
+	};
+
+	struct Solution
+	{
+		GameState::Move move;
+		Result result; // for the current player with the best play of both sides
+	};
+
+	static constexpr size_t DefaultMaxNodesCount = 1 << 16;
+	static constexpr size_t MaxCardsCount = 12; // in both hands, bigger endgames rarely fit into the nodes limit
+
+	struct Options
+	{
+		size_t maxNodesCount = DefaultMaxNodesCount; // per thread
+		size_t threadsCount = 1; // 0 - all hardware threads, the helpers fill the shared table for the main one
+		size_t maxCardsCount = MaxCardsCount; // bigger endgames aren't searched
+	};
+
+	Endgame();
+	explicit Endgame(const Options&);
+
+	static bool IsSolvable(const GameState&);
+
+	// best move for the current player of the state, nullopt if the state isn't solvable or the search gives up.
+	// After giving up it doesn't search again until there are fewer cards in the hands
+	std::optional<Solution> Solve(const GameState&);
+
+private:
+	class Worker;
+
+	enum class Bound : uint8_t
+	{
+		None,
+		Exact,
+		Lower,
+		Upper,
+	};
+
+	// the value is for the player to move, so entries don't depend on who asked
+	struct Entry
+	{
+		int8_t value = 0;
+		Bound bound = Bound::None;
+		uint8_t move = 0;
+	};
+
+	using Table = utility::transposition_table<Entry>;
+
+private:
+	Options _options;
+	std::optional<Table> _table; // allocated by the first solve, most games never get there
+	size_t _maxCardsCount; // the option, lowered below the cards count of a search that gave up
+};
\ No newline at end of file
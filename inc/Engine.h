@@ -0,0 +1,21 @@
+#pragma once
+#include <optional>
+#include <limits>
+#include "Card.h"
+#include "Player.h"
+
+class Context;
+
+class Engine final
+{
+public:
+	struct Result
+	{
+		std::optional<Player::Id> durak;
+		size_t roundsCount = 0;
+		bool interrupted = false;
+	};
+
+	static Player* FindFirstPlayer(Context&);
+	static Result Run(Context&, size_t maxRoundsCount = std::numeric_limits<size_t>::max());
+};
\ No newline at end of file
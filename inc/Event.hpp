@@ -1,13 +1,12 @@
 #pragma once
-#include <forward_list>
-#include <variant>
-#include <memory>
-#include <utility>
+#include <vector>
+#include <algorithm>
 
 class Player;
 class Deck;
 class Round;
 class Card;
+class CardSet;
 class Context;
 class PlayersGroup;
 struct Settings;
@@ -19,8 +18,8 @@ public:
 
 	virtual void OnPlayerAttack(const Player&, const Card&) {}
 	virtual void OnPlayerDefend(const Player&, const Card&) {}
-	virtual void OnPlayerDrawDeckCards(const Player&, const std::vector<Card>&) {}
-	virtual void OnPlayerDrawRoundCards(const Player&, const std::vector<Card>&) {}
+	virtual void OnPlayerDrawDeckCards(const Player&, const CardSet&) {}
+	virtual void OnPlayerDrawRoundCards(const Player&, const CardSet&) {}
 
 	virtual void OnRoundStart(const Round&) {}
 	virtual void OnRoundEnd(const Round&) {}
@@ -35,20 +34,18 @@ public:
 class EventHandlers final : public EventHandler
 {
 public:
-	static EventHandlers& Get()
-	{
-		static EventHandlers s_instance;
-		return s_instance;
-	}
+	EventHandlers() = default;
+	EventHandlers(const EventHandlers&) = delete;
+	EventHandlers& operator=(const EventHandlers&) = delete;
 
 	inline void Add(EventHandler* handler)
 	{
-		_handlers.push_front(handler);
+		_handlers.push_back(handler);
 	}
 
 	inline void Remove(EventHandler* handler)
 	{
-		_handlers.remove(handler);
+		_handlers.erase(std::remove(_handlers.begin(), _handlers.end(), handler), _handlers.end());
 	}
 
 public:
@@ -60,11 +57,11 @@ public:
 	{
 		forEach([&](EventHandler* handler) { handler->OnPlayerDefend(player, card); });
 	}
-	void OnPlayerDrawDeckCards(const Player& player, const std::vector<Card>& cards) override
+	void OnPlayerDrawDeckCards(const Player& player, const CardSet& cards) override
 	{
 		forEach([&](EventHandler* handler) { handler->OnPlayerDrawDeckCards(player, cards); });
 	}
-	void OnPlayerDrawRoundCards(const Player& player, const std::vector<Card>& cards) override
+	void OnPlayerDrawRoundCards(const Player& player, const CardSet& cards) override
 	{
 		forEach([&](EventHandler* handler) { handler->OnPlayerDrawRoundCards(player, cards); });
 	}
@@ -106,19 +103,23 @@ private:
 	}
 
 private:
-	std::forward_list<EventHandler*> _handlers;
+	std::vector<EventHandler*> _handlers;
 };
 
 class AutoEventHandler : private EventHandler
 {
 public:
-	AutoEventHandler()
+	AutoEventHandler(EventHandlers& handlers)
+		: _handlers(handlers)
 	{
-		EventHandlers::Get().Add(this);
+		_handlers.Add(this);
 	}
 
 	~AutoEventHandler()
 	{
-		EventHandlers::Get().Remove(this);
+		_handlers.Remove(this);
 	}
+
+private:
+	EventHandlers& _handlers;
 };
\ No newline at end of file
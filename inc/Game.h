@@ -1,7 +1,11 @@
 #pragma once
+#include <filesystem>
 
 class Game final
 {
 public:
 	void Run();
+
+	// plays back a game recorded into the log: space pauses, enter steps, the arrows seek by rounds and change the speed
+	void Run(const std::filesystem::path& log, size_t gameIndex);
 };
\ No newline at end of file
@@ -0,0 +1,218 @@
+#pragma once
+#include <stdint.h>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+#include "Card.h"
+#include "CardSet.hpp"
+#include "Event.hpp"
+#include "Player.h"
+#include "PlayersGroup.h"
+#include "Random.hpp"
+#include "Settings.h"
+
+// Append-only binary log of whole games. A file starts with the magic, then every game is a fixed header
+// followed by its events, one byte for the type and the player and one more for a card or a player if the type has it.
+// Games are appended whole, a batch of them at once, so several threads can record into the same log. The writes are
+// buffered: a crash loses the games since the last flush and the reader stops at a game cut short.
+class GameLog final
+{
+public:
+	enum class EventType : uint8_t
+	{
+		RoundStart, // the attacker, the defender in the value
+		RoundEnd, // the attacker
+		Attack,
+		Defend,
+		DrawDeckCard, // one event per card
+		DrawRoundCard, // one event per card
+		ShowTrumpCard,
+		UserWin,
+		UserLose,
+
+		Count,
+	};
+
+	struct Header
+	{
+		uint32_t eventsSize = 0; // in bytes
+		Random::Seed seed = 0;
+		std::array<Settings::Difficulty, PlayersGroup::MaxCount> difficulties{}; // by player id, Count for the user and the empty seats
+		uint8_t botsNumber = 0;
+		bool withUser = false;
+		uint8_t trumpCard = 0; // card index, the last card of the deck
+	};
+
+	struct Event
+	{
+		EventType type = EventType::RoundStart;
+		Player::Id player = 0;
+		uint8_t value = 0; // card index, or the defender for RoundStart
+
+		Card GetCard() const { return CardSet::GetCard(value); }
+	};
+
+	static constexpr char Magic[4] = { 'D', 'K', 'L', '2' };
+	static constexpr size_t HeaderSize = 15 + PlayersGroup::MaxCount;
+
+	static constexpr bool HasValue(EventType type)
+	{
+		return type != EventType::RoundEnd && type != EventType::UserWin && type != EventType::UserLose;
+	}
+
+	class Game;
+	class Reader;
+	class Batch;
+	class Recorder;
+
+	// opens the file for appending, creates it with the magic if it's missing
+	explicit GameLog(const std::filesystem::path&);
+	GameLog(const GameLog&) = delete;
+	GameLog& operator=(const GameLog&) = delete;
+	~GameLog(); // flushes
+
+	bool IsOpen() const;
+	void Append(const uint8_t* data, size_t size); // thread safe, a whole game at once. Buffered until the buffer fills
+	void Flush(); // thread safe, the games appended so far are in the file after it
+
+private:
+	static constexpr size_t BufferSize = 1 << 16;
+
+	std::mutex _mutex;
+	std::FILE* _file = nullptr;
+};
+
+// events of one game, read straight from the mapped file
+class GameLog::Game final
+{
+public:
+	Game(const Header& header, const uint8_t* events)
+		: _header(header)
+		, _events(events)
+	{}
+
+	const Header& GetHeader() const { return _header; }
+
+	// stops and returns true once the callback does
+	template<typename F>
+	bool ForEachEvent(const F& callback) const
+	{
+		for (const uint8_t* data = _events, * end = _events + _header.eventsSize; data < end;)
+		{
+			Event event;
+			event.type = static_cast<EventType>(*data >> 4);
+			event.player = static_cast<Player::Id>(*data++ & 0xF);
+			if (HasValue(event.type))
+			{
+				if (data == end)
+					break;
+				event.value = *data++;
+			}
+
+			if (callback(event))
+				return true;
+		}
+		return false;
+	}
+
+private:
+	Header _header;
+	const uint8_t* _events;
+};
+
+// maps the whole file, a game cut short by a crash ends the iteration
+class GameLog::Reader final
+{
+public:
+	explicit Reader(const std::filesystem::path&);
+	Reader(const Reader&) = delete;
+	Reader& operator=(const Reader&) = delete;
+	~Reader();
+
+	bool IsOpen() const;
+
+	// stops and returns true once the callback does
+	template<typename F>
+	bool ForEachGame(const F& callback) const
+	{
+		if (!IsOpen())
+			return false;
+
+		for (size_t offset = sizeof(Magic); _size - offset >= HeaderSize;)
+		{
+			const Header header = readHeader(_data + offset);
+			offset += HeaderSize;
+			if (_size - offset < header.eventsSize)
+				break;
+
+			if (callback(Game(header, _data + offset)))
+				return true;
+			offset += header.eventsSize;
+		}
+		return false;
+	}
+
+private:
+	static Header readHeader(const uint8_t*);
+
+private:
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+};
+
+// collects the games of one thread and appends them to the log together, so the threads rarely wait for each other.
+// Takes one recorder at a time, the game it records is at the end of the buffer
+class GameLog::Batch final
+{
+public:
+	explicit Batch(GameLog&);
+	Batch(const Batch&) = delete;
+	Batch& operator=(const Batch&) = delete;
+	~Batch(); // appends what's left
+
+private:
+	friend class Recorder;
+
+	void commit(); // a game is over
+
+private:
+	static constexpr size_t Capacity = 1 << 16; // appended once it's full
+
+	GameLog& _log;
+	std::vector<uint8_t> _data;
+};
+
+// writes the events of the context's game into the batch, the game is committed when it's over
+class GameLog::Recorder final : public AutoEventHandler
+{
+public:
+	// the settings are the ones the context is set up with
+	Recorder(Batch&, Context&, const Settings&);
+	~Recorder();
+
+private:
+	void OnPlayerAttack(const Player&, const Card&) override;
+	void OnPlayerDefend(const Player&, const Card&) override;
+	void OnPlayerDrawDeckCards(const Player&, const CardSet&) override;
+	void OnPlayerDrawRoundCards(const Player&, const CardSet&) override;
+	void OnRoundStart(const Round&) override;
+	void OnRoundEnd(const Round&) override;
+	void OnPlayersCreated(const PlayersGroup&) override;
+	void OnPlayerShowTrumpCard(const Player&, const Card&) override;
+	void OnUserWin(const Player&) override;
+	void OnUserLose(const Player&) override;
+
+	void add(EventType, const Player&);
+	void add(EventType, const Player&, uint8_t value);
+	void finish();
+
+private:
+	static constexpr size_t NoGame = SIZE_MAX;
+
+	Batch& _batch;
+	const Context& _context;
+	Header _header;
+	size_t _start = NoGame; // of the game in the batch, the header is written there when it's over
+};
\ No newline at end of file
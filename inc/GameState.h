@@ -0,0 +1,150 @@
+#pragma once
+#include <array>
+#include <optional>
+#include "Card.h"
+#include "CardSet.hpp"
+#include "Hand.h"
+
+class Deck;
+
+// Flat copy of everything the rules depend on. Round keeps it in sync with the live game,
+// and search can copy it freely or play moves on it and take them back.
+class GameState final
+{
+public:
+	using PlayerIndex = uint8_t;
+	static constexpr size_t MaxPlayersCount = CardSet::MaxCount / Hand::MinCount;
+
+	using Key = uint64_t;
+
+	// one bit per card plus one for pass or take
+	using MoveMask = uint64_t;
+	static constexpr size_t NoCardMove = CardSet::MaxCount;
+
+	enum class Phase : uint8_t
+	{
+		Attack,
+		Defend,
+		Over,
+	};
+
+	class Move final
+	{
+	public:
+		enum class Type : uint8_t
+		{
+			Play,
+			Pass, // attacker doesn't add a card
+			Take, // defender takes the table
+		};
+
+		static Move Play(const Card&);
+		static Move Pass();
+		static Move Take();
+
+		Type GetType() const { return _type; }
+		std::optional<Card> GetCard() const;
+		bool operator==(const Move&) const = default;
+
+	private:
+		Move(Type, uint8_t card = 0);
+
+	private:
+		Type _type;
+		uint8_t _card;
+	};
+
+private:
+	struct Header
+	{
+		uint8_t deckIndex = 0;
+		uint8_t playersMask = 0;
+		PlayerIndex attacker = 0;
+		PlayerIndex defender = 0;
+		uint8_t turn = 0; // offset of the current attacker from the main one
+		uint8_t attacksLimit = 0;
+		uint8_t lastAttackCard = 0;
+		Phase phase = Phase::Over;
+	};
+
+public:
+	class Undo final
+	{
+	private:
+		friend class GameState;
+		Undo(const Header&, const CardSet& attackCards, const CardSet& defendCards, Key cardsKey, const Move&);
+
+	private:
+		Header _header;
+		CardSet _attackCards;
+		CardSet _defendCards;
+		Key _cardsKey;
+		Move _move;
+	};
+
+	GameState() = default;
+	GameState(const Deck&, size_t playersCount);
+
+	void Start(PlayerIndex attacker);
+	Undo ApplyMove(const Move&);
+	void UndoMove(const Undo&);
+
+	Phase GetPhase() const;
+	PlayerIndex GetCurrentPlayer() const;
+	PlayerIndex GetAttacker() const;
+	PlayerIndex GetDefender() const;
+	size_t GetPlayersCount() const;
+	bool IsInGame(PlayerIndex) const;
+
+	// Zobrist key of the position, the order of the cards left in the deck isn't part of it
+	Key GetKey() const;
+
+	Card::Suit GetTrumpSuit() const;
+	const CardSet& GetHand(PlayerIndex) const;
+	const CardSet& GetAttackCards() const;
+	const CardSet& GetDefendCards() const;
+	CardSet GetTableCards() const;
+	CardSet GetDiscardPile() const;
+	size_t GetDeckCount() const;
+	std::optional<Card> GetDeckCard(size_t i) const;
+
+	// for sampling hidden cards, the counts must stay the same
+	void SetHand(PlayerIndex, const CardSet&);
+	void SetDeckCard(size_t i, const Card&);
+
+	// cards the current player may play, regardless of the hand
+	CardSet GetAllowedCards() const;
+	CardSet GetPlayableCards() const;
+	MoveMask GetLegalMoves() const;
+	Move GetMove(size_t legalMove) const;
+
+private:
+	PlayerIndex next(PlayerIndex) const;
+	PlayerIndex getAttackPlayer(size_t turn) const;
+	void startRound(PlayerIndex attacker);
+	void endRound(bool defenderLost);
+	void drawCards(PlayerIndex);
+	void toggleCards(const CardSet&, size_t place);
+
+	template<typename F>
+	void forEachPlayer(PlayerIndex start, const F& callback) const
+	{
+		PlayerIndex player = start;
+		do
+		{
+			if (callback(player))
+				return;
+			player = next(player);
+		} while (player != start);
+	}
+
+private:
+	std::array<uint8_t, CardSet::MaxCount> _deck{};
+	std::array<CardSet, MaxPlayersCount> _hands;
+	CardSet _attackCards;
+	CardSet _defendCards;
+	Header _header;
+	Key _cardsKey = 0; // updated as the cards move, discarded cards have no keys
+	uint8_t _deckCount = 0;
+	Card::Suit _trumpSuit = Card::Suit::Hearts;
+};
\ No newline at end of file
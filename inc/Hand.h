@@ -1,7 +1,6 @@
 #pragma once
-#include <deque>
-#include <functional>
 #include "Card.h"
+#include "CardSet.hpp"
 
 class Hand
 {
@@ -13,19 +12,17 @@ public:
 	bool IsEmpty() const;
 	size_t GetCardCount() const;
 	Card GetCard(size_t) const;
+	const CardSet& GetCards() const;
 	Hand& AddCard(const Card&);
+	Hand& AddCards(const CardSet&);
 	Hand& RemoveCard(const Card&);
 
-	using Callback = std::function<bool(const Card&)>;
-	bool ForEachCard(const Callback&) const;
-
-	template<typename T>
-	Hand& AddCards(T&& begin, T&& end)
+	template<typename F>
+	bool ForEachCard(const F& callback) const
 	{
-		_deque.insert(_deque.end(), std::forward<T>(begin), std::forward<T>(end));
-		return *this;
+		return _cards.ForEach(callback);
 	}
 
 private:
-	std::deque<Card> _deque;
+	CardSet _cards;
 };
\ No newline at end of file
@@ -1,16 +1,22 @@
 #pragma once
-#include <functional>
 #include <optional>
+#include <memory>
+#include <chrono>
 
+namespace sf
+{
+	class RenderTarget;
+	template<typename T> class Vector2;
+	typedef Vector2<float> Vector2f;
+}
 class Card;
+class CardSet;
 class Context;
 struct Settings;
 
 class IController
 {
 public:
-	using PickCardFilter = std::function<bool(const Card&)>;
-
 	class UserPick
 	{
 	public:
@@ -23,7 +29,7 @@ public:
 
 	IController() = default;
 	virtual ~IController() = default;
-	virtual void Pick(const Context&, std::shared_ptr<UserPick>) = 0;
-	virtual std::optional<Card> UserPickCard(const Context&, bool attacking, const PickCardFilter&) = 0;
+	virtual std::optional<Card> UserPickCard(const Context&, bool attacking, const CardSet& playableCards) = 0;
 	virtual void SetSettings(const Context&, Settings&) = 0;
+	virtual void Wait(const Context&, std::chrono::steady_clock::time_point until) = 0;
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <optional>
+#include "Event.hpp"
+#include "CardSet.hpp"
+#include "GameState.h"
+#include "Player.h"
+
+// What one player has seen of the game. Every event updates a few masks,
+// so the queries are cheap enough to be asked on every search step.
+class Memory final : public AutoEventHandler
+{
+public:
+	Memory(const Player& owner, EventHandlers&);
+
+	// cards seen entering the player's hand and not played since
+	const CardSet& GetKnownCards(Player::Id) const;
+	const CardSet& GetDiscardPile() const;
+	const CardSet& GetTableCards() const;
+
+	// cards not seen anywhere, they are in the deck or in the other players' hands
+	CardSet GetUnseenCards() const;
+
+	// cards that may be in the player's hand
+	CardSet GetPossibleCards(Player::Id) const;
+	CardSet GetPossibleBeatingCards(Player::Id, const Card&, Card::Suit trumpSuit) const;
+
+	// cards the player's own moves say they don't have: trumps lower than the one shown at the start,
+	// cards of the suit beating one they took instead. Forgotten once the player draws from the deck
+	// or plays one of them anyway
+	CardSet GetImpossibleCards(Player::Id, Card::Suit trumpSuit) const;
+
+private:
+	void OnPlayerShowTrumpCard(const Player&, const Card&) override;
+	void OnPlayerAttack(const Player&, const Card&) override;
+	void OnPlayerDefend(const Player&, const Card&) override;
+	void OnPlayerDrawDeckCards(const Player&, const CardSet&) override;
+	void OnPlayerDrawRoundCards(const Player&, const CardSet&) override;
+	void OnRoundEnd(const Round&) override;
+
+	void onPlayCard(const Player&, const Card&);
+	void forgetImpossibleCards(Player::Id);
+
+private:
+	const Player& _owner;
+	std::array<CardSet, GameState::MaxPlayersCount> _knownCards;
+	CardSet _allKnownCards;
+	CardSet _discardPile;
+	CardSet _tableCards;
+	std::array<CardSet, GameState::MaxPlayersCount> _lowerTrumps;
+	std::array<CardSet, GameState::MaxPlayersCount> _notBeatenCards; // attack cards the player took
+	std::optional<Card> _openCard; // attack card not beaten yet
+};
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <type_traits>
+
+class Context;
+struct Settings;
+
+// Gives people watching the game time to follow it. The controller shows the delays while drawing,
+// without a controller they take no time at all.
+class Pacer final
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	using Duration = std::chrono::milliseconds;
+
+	void Setup(const Settings&);
+
+	void Wait(const Context&, Duration) const;
+	Duration GetPauseDelay() const; // the controller holds the trump card or the next attacker on the screen that long
+	float GetSpeed() const; // for the controller animations, 0 - instant
+
+	// the controller doesn't block in Wait, so the bot thinks first and only what's left of its delay is shown
+	template<typename F>
+	std::invoke_result_t<F> RunBotMove(const Context& context, F&& think) const
+	{
+		if (!isPaced(context, _botDelay))
+			return std::forward<F>(think)();
+
+		const auto start = Clock::now();
+		auto move = std::forward<F>(think)();
+		Wait(context, std::max(_botDelay - std::chrono::duration_cast<Duration>(Clock::now() - start), Duration{}));
+		return move;
+	}
+
+private:
+	static bool isPaced(const Context&, Duration);
+
+private:
+	Duration _botDelay{};
+	Duration _pauseDelay{};
+	float _speed = 1.f;
+};
\ No newline at end of file
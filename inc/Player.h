@@ -1,10 +1,9 @@
 #pragma once
 #include <optional>
-#include <functional>
 #include "Hand.h"
 #include "Card.h"
+#include "CardSet.hpp"
 
-class Deck;
 class Context;
 class Round;
 
@@ -12,17 +11,15 @@ class Player
 {
 public:
 	using Id = uint8_t;
-	using CardFilter = std::function<bool(const Card&)>;
 
 	Player(Id);
 	virtual ~Player() = default;
 
-	std::optional<Card> Attack(const Context&, const Player& defender, const CardFilter&);
-	std::optional<Card> Defend(const Context&, const Player& attacker, const CardFilter&);
+	std::optional<Card> Attack(Context&, const Player& defender, const CardSet& allowedCards);
+	std::optional<Card> Defend(Context&, const Player& attacker, const CardSet& allowedCards);
 
-	Player& DrawCards(Deck&);
-	Player& DrawCards(const std::vector<Card>&);
-	Player& DrawCards(std::vector<Card>&&);
+	Player& DrawCards(Context&);
+	Player& DrawCards(Context&, const CardSet&);
 	std::optional<Card> FindLowestTrumpCard(Card::Suit) const;
 	Id GetId() const;
 
@@ -32,8 +29,8 @@ public:
 protected:
 	Player() = default;
 
-	virtual std::optional<Card> pickAttackCard(const Context&, const Player& defender, const CardFilter&) const = 0;
-	virtual std::optional<Card> pickDefendCard(const Context&, const Player& attacker, const CardFilter&) const = 0;
+	virtual std::optional<Card> pickAttackCard(const Context&, const Player& defender, const CardSet& playableCards) const = 0;
+	virtual std::optional<Card> pickDefendCard(const Context&, const Player& attacker, const CardSet& playableCards) const = 0;
 	
 private:
 	void removeCard(const std::optional<Card>&);
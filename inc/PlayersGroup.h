@@ -1,40 +1,107 @@
 #pragma once
-#include <functional>
+#include <array>
+#include <bit>
+#include <memory>
 #include "Player.h"
-#include "Utility.hpp"
+#include "GameState.h"
 
-class Deck;
+class Context;
+class EventHandlers;
 struct Settings;
 
+// Seats indexed by Player::Id. Players who leave the game keep their seat but are skipped.
 class PlayersGroup
 {
 public:
-	PlayersGroup(const Settings&);
+	static constexpr size_t MaxCount = GameState::MaxPlayersCount;
+
+	PlayersGroup(const Settings&, EventHandlers&);
 	~PlayersGroup();
-	void DrawCards(Deck&, Player* start = nullptr);
+	void DrawCards(Context&, Player* start = nullptr);
 
 	Player& Next(const Player&) const;
+	Player& Previous(const Player&) const;
 	Player* GetUser() const;
+	Player* GetFirst() const;
 	size_t GetCount() const;
 
 	Player& GetDefender(const Player& attacker) const;
 
-	using RemoveIfCallback = std::function<bool(const Player*)>;
-	void RemoveIf(const RemoveIfCallback&);
+	template<typename F>
+	void RemoveIf(const F& removeIf)
+	{
+		for (Mask mask = _activeMask; mask; mask &= mask - 1)
+		{
+			const Mask seat = lowestSeat(mask);
+			if (removeIf(static_cast<const Player*>(_seats[seat].get())))
+				_activeMask &= ~(Mask{ 1 } << seat);
+		}
+	}
+
+	template<typename F>
+	bool ForEach(const F& callback, const Player* start = nullptr) const
+	{
+		if (!start)
+			start = GetFirst();
+		return start && forEachSeat(start->GetId(), callback);
+	}
+
+	// players who neither defend nor attack first, ending with the attacker
+	template<typename F>
+	bool ForEachIdlePlayer(const F& callback, const Player* attacker) const
+	{
+		if (!attacker)
+			return false;
+
+		bool result = false;
+		forEachSeat(Next(GetDefender(*attacker)).GetId(), [&](Player* player)
+			{
+				result = callback(player);
+				return result || attacker->GetId() == player->GetId();
+			});
+		return result;
+	}
 
-	using ForEachCallback = std::function<bool(Player*)>;
-	bool ForEach(const ForEachCallback&, const Player* start = nullptr) const;
-	bool ForEachIdlePlayer(const ForEachCallback&, const Player* attacker) const;
-	bool ForEachAttackPlayer(const ForEachCallback&, const Player* attacker);
-	bool ForEachOtherPlayer(const ForEachCallback&, const Player* exclude, const Player* start = nullptr) const;
+	template<typename F>
+	bool ForEachAttackPlayer(const F& callback, const Player* attacker) const
+	{
+		return attacker && ForEachOtherPlayer(callback, &GetDefender(*attacker), attacker);
+	}
+
+	template<typename F>
+	bool ForEachOtherPlayer(const F& callback, const Player* exclude, const Player* start = nullptr) const
+	{
+		return ForEach([&](Player* player)
+			{
+				return (!exclude || exclude->GetId() != player->GetId()) && callback(player);
+			}, start);
+	}
 
 private:
-	struct Hash
+	using Mask = uint8_t;
+
+	static Mask lowestSeat(Mask mask)
 	{
-		size_t operator()(const Player& player) const { return std::hash<Player::Id>{}(player.GetId()); }
-	};
-	using PlayerLoop = utility::loop_list<Player, Hash>;
+		return static_cast<Mask>(std::countr_zero(mask));
+	}
 
-	PlayerLoop _playerLoop;
+	template<typename F>
+	bool forEachSeat(Player::Id start, const F& callback) const
+	{
+		const Mask before = static_cast<Mask>((Mask{ 1 } << start) - 1);
+		for (const Mask part : { static_cast<Mask>(_activeMask & ~before), static_cast<Mask>(_activeMask & before) })
+		{
+			for (Mask mask = part; mask; mask &= mask - 1)
+			{
+				if (callback(_seats[lowestSeat(mask)].get()))
+					return true;
+			}
+		}
+		return false;
+	}
+
+private:
+	std::array<std::unique_ptr<Player>, MaxCount> _seats;
+	Mask _activeMask = 0;
 	Player* _user = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <optional>
+
+namespace sf
+{
+	class RenderTarget;
+}
+
+// Frame timings drawn over the game. While it's hidden, measuring costs a branch.
+class Profiler final
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Section : uint8_t
+	{
+		Table,
+		Deck,
+		Players,
+		RoundCards,
+		Batch, // submitting the cards
+
+		Count,
+	};
+
+	struct Counters
+	{
+		size_t drawings = 0; // drawn by UI::update, a batch counts once
+		size_t cards = 0; // in the batch
+		size_t animations = 0; // cards that are moving
+		size_t queuedEvents = 0; // posted by the game thread, not played yet
+	};
+
+	class Scope final
+	{
+	public:
+		Scope(Profiler& profiler, Section section)
+			: _profiler(profiler.IsEnabled() ? &profiler : nullptr)
+			, _section(section)
+		{
+			if (_profiler)
+				_start = Clock::now();
+		}
+
+		~Scope()
+		{
+			if (_profiler)
+				_profiler->add(_section, Clock::now() - _start);
+		}
+
+	private:
+		Profiler* _profiler;
+		Section _section;
+		Clock::time_point _start;
+	};
+
+	bool IsEnabled() const { return _enabled; }
+	void Toggle();
+
+	// the update is the drawing of the frame, the frame is the time from one present to the next
+	void BeginFrame();
+	void EndFrame(const Counters&);
+	void Present(); // after the window is displayed, so vsync and the driver stalls are counted
+	void Pause(); // the window isn't redrawn for a while, the wait isn't a frame
+	void Draw(sf::RenderTarget&) const;
+
+private:
+	static constexpr size_t FramesCount = 120;
+	static constexpr size_t SectionsCount = static_cast<size_t>(Section::Count);
+
+	using Times = std::array<Clock::duration, FramesCount>; // a ring of the last frames
+
+	void add(Section, Clock::duration);
+
+private:
+	bool _enabled = false;
+	Clock::time_point _updateStart;
+	Times _updateTimes{};
+	size_t _updatesCount = 0;
+	std::optional<Clock::time_point> _lastPresent;
+	Times _frameTimes{};
+	size_t _framesCount = 0;
+	std::array<Clock::duration, SectionsCount> _sections{}; // of the current frame
+	std::array<Clock::duration, SectionsCount> _lastSections{};
+	Counters _counters;
+};
\ No newline at end of file
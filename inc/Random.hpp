@@ -1,23 +1,53 @@
 #pragma once
 #include <random>
+#include <algorithm>
+#include <stdint.h>
 
 class Random final
 {
 public:
 	using Generator = std::mt19937;
+	using Seed = uint64_t;
 
-	static Generator& GetGenerator()
+	static Seed MakeSeed()
 	{
-		return _generator;
+		std::random_device device;
+		const Seed high = device();
+		const Seed low = device();
+		return (high << 32) | low;
 	}
 
+	// splitmix64, gives independent seeds for the streams of one base seed
+	static constexpr Seed MakeSeed(Seed seed, uint64_t stream)
+	{
+		Seed z = seed + (stream + 1) * 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	static Generator MakeGenerator(Seed seed)
+	{
+		std::seed_seq sequence{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+		return Generator(sequence);
+	}
+
+	// unlike std::uniform_int_distribution the result doesn't depend on the standard library
 	template<typename T>
-	static T GetNumber(T max, T min = 0)
+	static T GetNumber(Generator& generator, T max, T min = 0)
 	{
-		std::uniform_int_distribution<T> range(min, max);
-		return range(_generator);
+		const uint64_t range = static_cast<uint64_t>(max - min) + 1;
+		// separate statements, the order of the operands of | is up to the compiler
+		const uint64_t high = generator();
+		const uint64_t low = generator();
+		const uint64_t value = (high << 32) | low;
+		return min + static_cast<T>(value % range);
 	}
 
-private:
-	inline static Generator _generator = Generator(std::random_device{}());
+	template<typename It>
+	static void Shuffle(Generator& generator, It begin, It end)
+	{
+		for (auto i = end - begin - 1; i > 0; --i)
+			std::iter_swap(begin + i, begin + GetNumber(generator, i));
+	}
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "CardSet.hpp"
+#include "Deck.h"
+#include "GameLog.h"
+#include "Player.h"
+#include "PlayersGroup.h"
+#include "Round.h"
+#include "Settings.h"
+#include "Utility.hpp"
+
+class Context;
+
+// Plays a recorded game back through the events of a context, so the controller shows it the way it shows a game.
+// The state is saved every few steps: a seek fast-forwards from the closest snapshot and shows the result at once.
+class Replay final
+{
+public:
+	enum class Command : uint8_t
+	{
+		Pause, // or resume
+		Step, // pauses and plays one step
+		Back, // to the start of the round, of the previous one if it has just started
+		Forward, // to the start of the next round
+		Faster,
+		Slower,
+		Stop,
+	};
+
+	static constexpr size_t SnapshotPeriod = 16; // in steps
+
+	// sets the context up for the game, handlers added after that see the replay only.
+	// A log damaged in the middle of the game is played up to the damage
+	Replay(Context&, const GameLog::Game&, float speed = 1.f);
+
+	size_t GetStepsCount() const;
+	size_t GetPosition() const; // steps played
+
+	bool Step(); // plays the next step, false at the end
+	void Seek(size_t position); // shows the game as it was after that many steps, without animations
+
+	// plays the game at the pace of the speed until it's stopped, the commands are posted by another thread
+	void Run();
+	void Post(Command); // thread safe, waits while the replay is behind with the commands
+
+private:
+	// an event of the game, all the cards of a draw are drawn at once the way the game sends them
+	struct Action
+	{
+		GameLog::EventType type = GameLog::EventType::RoundStart;
+		Player::Id player = 0;
+		uint8_t value = 0; // card index or the defender, like in the log
+		CardSet cards; // drawn
+	};
+
+	struct State
+	{
+		std::array<CardSet, PlayersGroup::MaxCount> hands;
+		std::array<uint8_t, 2 * Round::MaxAttacksCount> roundCards{}; // attacks and defences by turns
+		std::array<Player::Id, 2 * Round::MaxAttacksCount> roundPlayers{};
+		uint8_t roundCardsCount = 0;
+		uint8_t deckCount = 0;
+		Player::Id attacker = 0;
+		Player::Id defender = 0;
+		bool userWon = false;
+		bool userLost = false;
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	bool addAction(const GameLog::Event&);
+	static void apply(State&, const Action&);
+	void play(const Action&);
+	void show(const State&);
+	void setSpeed(float);
+	Clock::duration getDelay(const Action&) const;
+	void handle(Command, Clock::time_point& next);
+	void wait(Clock::time_point until);
+
+private:
+	static constexpr size_t CommandsCapacity = 64;
+	static constexpr float MinSpeed = 0.125f;
+	static constexpr float MaxSpeed = 8.f;
+
+	Context& _context;
+	Settings _settings;
+	Deck _deck; // full, the context's deck is restored from it
+	std::array<Player*, PlayersGroup::MaxCount> _players{};
+	size_t _playersCount = 0;
+	std::vector<Action> _actions;
+	std::vector<size_t> _roundStarts; // positions of the RoundStart actions
+	std::vector<State> _snapshots; // before every SnapshotPeriod actions
+	State _state;
+	size_t _position = 0;
+	bool _paused = false;
+	utility::spsc_queue<Command, CommandsCapacity> _commands;
+	std::mutex _wakeMutex;
+	std::condition_variable _wakeCondition;
+	bool _awake = false;
+};
\ No newline at end of file
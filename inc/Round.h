@@ -1,7 +1,7 @@
 #pragma once
 #include <memory>
-#include <vector>
 #include "Hand.h"
+#include "CardSet.hpp"
 
 class Context;
 class Player;
@@ -9,7 +9,7 @@ class Player;
 class Round
 {
 public:
-	using Cards = std::vector<Card>;
+	using Cards = CardSet;
 	static constexpr size_t MaxAttacksCount = Hand::MinCount;
 
 	Round() = delete;
@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include "CardSet.hpp"
+#include "GameState.h"
+#include "Random.hpp"
+
+// Deals the cards a player can't see so that every deal agrees with what the player believes.
+// The constraints are turned into masks once, then each card is picked from the ones that keep
+// the rest of the deal possible, so no deal is ever rejected.
+class Sampler final
+{
+public:
+	// what the sampling player believes about the hand of another one
+	struct Belief
+	{
+		CardSet knownCards; // seen entering the hand and not played since
+		CardSet impossibleCards; // ruled out by the player's moves, ignored in a deal they don't fit
+	};
+
+	using Beliefs = std::array<Belief, GameState::MaxPlayersCount>;
+
+	// for the current player of the state
+	Sampler(const GameState&, const Beliefs&);
+
+	// deals the hidden cards of a copy of the state given to the constructor
+	void Deal(GameState&, Random::Generator&) const;
+
+private:
+	struct Hand
+	{
+		GameState::PlayerIndex player = 0;
+		CardSet knownCards;
+		CardSet allowedCards;
+		size_t count = 0; // cards to deal
+	};
+
+	// every group of other players' hands, as a mask of their indices in _hands
+	static constexpr size_t GroupsCount = size_t{ 1 } << (GameState::MaxPlayersCount - 1);
+
+	CardSet::Mask pickChecked(const Hand&, size_t laterHands, CardSet::Mask cards, Random::Generator&) const;
+	void setGroups();
+
+	CardSet _hiddenCards; // without the known ones
+	std::array<Hand, GameState::MaxPlayersCount - 1> _hands;
+	size_t _handsCount = 0;
+	size_t _deckCount = 0; // without the trump card
+	std::array<CardSet::Mask, GroupsCount> _groupCards{}; // allowed in any hand of the group
+	std::array<uint8_t, GroupsCount> _groupCounts{}; // cards to deal to the group
+};
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include "GameState.h"
+#include "Random.hpp"
+#include "Sampler.h"
+
+// Information set Monte Carlo tree search. Every iteration deals the cards the searching player
+// can't see at random, so the tree is built over what the player knows rather than over one guess.
+class Search final
+{
+public:
+	struct Options
+	{
+		std::chrono::milliseconds time{}; // 0 - no limit
+		size_t iterations = 0; // per thread, 0 - no limit
+		size_t threadsCount = 0; // 0 - all hardware threads
+	};
+
+	// what the current player believes about the hands of the others
+	using Beliefs = Sampler::Beliefs;
+
+	// best move for the current player of the state
+	static GameState::Move FindMove(const GameState&, const Beliefs&, const Options&, Random::Seed);
+};
\ No newline at end of file
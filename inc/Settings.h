@@ -1,5 +1,9 @@
 #pragma once
 #include <stdint.h>
+#include <chrono>
+#include <optional>
+#include <vector>
+#include "Random.hpp"
 
 struct Settings
 {
@@ -13,5 +17,19 @@ struct Settings
 	};
 
 	Difficulty difficulty = Difficulty::Medium;
+	std::vector<Difficulty> botsDifficulties; // by bot, the bots past the end play the difficulty
 	size_t botsNumber = 1;
+	bool withUser = true;
+	std::chrono::milliseconds botDelay = std::chrono::seconds(1); // shown while the bot thinks
+	std::chrono::milliseconds pauseDelay = std::chrono::seconds(1); // to show the trump card and the next attacker
+	float speed = 1.f; // divides the delays and speeds up the animations, 0 - instant
+	std::chrono::milliseconds botThinkTime = std::chrono::milliseconds(500); // hard bot search budget per move, 0 - no limit
+	size_t botSearchIterations = 0; // per search thread, 0 - no limit
+	size_t botSearchThreadsCount = 0; // 0 - all hardware threads
+	std::optional<Random::Seed> seed; // fixes the deal and every bot choice
+
+	Difficulty GetBotDifficulty(size_t bot) const
+	{
+		return bot < botsDifficulties.size() ? botsDifficulties[bot] : difficulty;
+	}
 };
\ No newline at end of file
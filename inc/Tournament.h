@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <optional>
+#include "Settings.h"
+
+class GameLog;
+
+class Tournament final
+{
+public:
+	struct Options
+	{
+		Settings settings;
+		size_t gamesCount = 0;
+		size_t threadsCount = 0; // 0 - all hardware threads
+		size_t maxRoundsCount = 1000;
+		std::optional<Random::Seed> seed; // game i is played with Random::MakeSeed(seed, i)
+		GameLog* log = nullptr; // records every game when set
+	};
+
+	struct Result
+	{
+		size_t gamesCount = 0;
+		size_t roundsCount = 0;
+		size_t drawsCount = 0;
+		size_t interruptedCount = 0;
+		std::vector<size_t> durakCount; // indexed by Player::Id
+		size_t threadsCount = 0;
+		double seconds = 0.;
+
+		Result& Merge(const Result&);
+		double GetGamesPerSecond() const;
+	};
+
+	static Result Run(const Options&);
+};
\ No newline at end of file
@@ -1,10 +1,19 @@
 #pragma once
 #include <memory>
 #include <optional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include <SFML/Graphics.hpp>
 #include <SFML/Window/Cursor.hpp>
 #include "IController.h"
+#include "Profiler.h"
 #include "Card.h"
+#include "CardSet.hpp"
+#include "Player.h"
+#include "Settings.h"
+#include "Utility.hpp"
 
 namespace sf
 {
@@ -12,12 +21,10 @@ namespace sf
 	class Event;
 }
 class Round;
-class Player;
 class Deck;
 class Context;
 class User;
 class PlayersGroup;
-struct Settings;
 
 class UI final : public IController
 {
@@ -27,18 +34,23 @@ public:
 
 	sf::RenderWindow& GetWindow();
 	const sf::RenderWindow& GetWindow() const;
-	bool NeedsToUpdate() const;
+	// called by the thread polling the window, the event is handled on the next frame, false if it's dropped
 	bool HandleEvent(const sf::Event&);
 	void CloseWindow();
 
-	void Pick(const Context&, std::shared_ptr<UserPick>) override;
-	std::optional<Card> UserPickCard(const Context&, bool attacking, const PickCardFilter&) override;
+	// draws the next frame if anything changed, otherwise waits for a change, called by the render thread only
+	void Update();
+	void Wake(); // makes a waiting Update return
+
+	// called by the game thread, they only post events the window thread plays back at its own pace
+	std::optional<Card> UserPickCard(const Context&, bool attacking, const CardSet& playableCards) override;
 	void SetSettings(const Context&, Settings&) override;
+	void Wait(const Context&, std::chrono::steady_clock::time_point until) override;
 
 	void OnPlayerAttack(const Context&, const Player&, const Card&);
 	void OnPlayerDefend(const Context&, const Player&, const Card&);
-	void OnPlayerDrawDeckCards(const Context&, const Player&, const std::vector<Card>&);
-	void OnPlayerDrawRoundCards(const Context&, const Player&, const std::vector<Card>&);
+	void OnPlayerDrawDeckCards(const Context&, const Player&, const CardSet&);
+	void OnPlayerDrawRoundCards(const Context&, const Player&, const CardSet&);
 	void OnRoundStart(const Context&, const Round&);
 	void OnRoundEnd(const Context&, const Round&);
 	void OnPlayersCreated(const Context&, const PlayersGroup&);
@@ -51,15 +63,66 @@ private:
 	sf::Vector2f toModel(const sf::Vector2i&) const;
 	sf::Vector2i toScreen(const sf::Vector2f&) const;
 
-	void onPlayerPlaceCard(const Context&, const Player&, const Card&);
+	struct Event
+	{
+		enum class Type : uint8_t
+		{
+			PlayerAttack,
+			PlayerDefend,
+			PlayerDrawDeckCards,
+			PlayerDrawRoundCards,
+			RoundStart,
+			RoundEnd,
+			PlayersCreated,
+			PlayerShowTrumpCard,
+			StartGame,
+			UserWin,
+			UserLose,
+			Wait,
+			PickCard,
+			PickDifficulty,
+		};
+
+		Type type = Type::StartGame;
+		Player::Id player = 0; // the attacker for RoundStart, the user for PlayersCreated
+		Player::Id other = 0; // the defender for RoundStart
+		uint8_t playersCount = 0;
+		uint8_t deckCount = 0; // cards left in the deck after the event
+		bool attacking = false;
+		CardSet cards; // the trump card for PlayersCreated
+		std::chrono::milliseconds duration{}; // how long to keep the result on the screen
+		float speed = 1.f; // of the animations from the event on, 0 - instant
+		std::promise<std::optional<Card>>* pickedCard = nullptr;
+		std::promise<Settings::Difficulty>* pickedDifficulty = nullptr;
+	};
+
+	void post(const Context&, Event);
+	void handleEvent(const sf::Event&);
+	bool applyEvents();
+	void waitForChanges();
+	void apply(const Event&);
+	void pick(std::shared_ptr<UserPick>, std::function<void()> onPick);
+
 	sf::Vector2f getDeckPosition() const;
-	void animate(const Context&);
-	void update(const Context&, sf::Time delta);
+	bool update(sf::Time delta);
 
 private:
 	struct Data;
 
+	static constexpr size_t EventsCapacity = 1024;
+	static constexpr size_t InputsCapacity = 256;
+
 	sf::RenderWindow _window;
 	sf::Cursor::Type _cursorType = sf::Cursor::Arrow;
+	sf::Clock _clock;
+	std::chrono::steady_clock::time_point _lastFrame;
+	bool _redraw = true;
+	bool _focused = true;
+	std::mutex _wakeMutex;
+	std::condition_variable _wakeCondition;
+	bool _awake = false;
 	std::unique_ptr<Data> _data;
+	Profiler _profiler; // toggled with F3
+	utility::spsc_queue<Event, EventsCapacity> _events; // from the game thread
+	utility::spsc_queue<sf::Event, InputsCapacity> _inputs; // from the input thread
 };
\ No newline at end of file
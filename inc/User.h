@@ -7,6 +7,6 @@ public:
 	using Player::Player;
 
 protected:
-	std::optional<Card> pickAttackCard(const Context&, const Player& defender, const CardFilter&) const override;
-	std::optional<Card> pickDefendCard(const Context&, const Player& attacker, const CardFilter&) const override;
+	std::optional<Card> pickAttackCard(const Context&, const Player& defender, const CardSet& playableCards) const override;
+	std::optional<Card> pickDefendCard(const Context&, const Player& attacker, const CardSet& playableCards) const override;
 };
\ No newline at end of file
@@ -1,8 +1,14 @@
-﻿#include "Game.h"
+﻿#include <cstdlib>
+#include "Game.h"
 
-int main()
+// durak1 [log file] [game index], plays back a recorded game when the log is given
+// the games played are recorded into durak/durak.log in the user data directory
+int main(int argc, char* argv[])
 {
 	Game game;
-	game.Run();
+	if (argc > 1)
+		game.Run(argv[1], argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0);
+	else
+		game.Run();
 	return 0;
 }
\ No newline at end of file
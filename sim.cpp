@@ -0,0 +1,89 @@
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include "GameLog.h"
+#include "Settings.h"
+#include "Tournament.h"
+
+namespace
+{
+	inline std::optional<Settings::Difficulty> parseDifficulty(std::string_view value)
+	{
+		if (value == "easy")
+			return Settings::Difficulty::Easy;
+		if (value == "medium")
+			return Settings::Difficulty::Medium;
+		if (value == "hard")
+			return Settings::Difficulty::Hard;
+		return std::nullopt;
+	}
+
+	// one difficulty for every bot, or a list like hard,medium by bot ids. False if a name is unknown
+	inline bool parseDifficulties(std::string_view value, Settings& settings)
+	{
+		for (size_t start = 0, end = 0; end != std::string_view::npos; start = end + 1)
+		{
+			end = value.find(',', start);
+			const auto difficulty = parseDifficulty(value.substr(start, end - start));
+			if (!difficulty)
+				return false;
+			settings.botsDifficulties.push_back(*difficulty);
+		}
+
+		settings.difficulty = settings.botsDifficulties.front();
+		if (settings.botsDifficulties.size() == 1)
+			settings.botsDifficulties.clear();
+		return true;
+	}
+}
+
+// durak_sim [games] [bots] [easy|medium|hard or one per bot: hard,medium] [threads] [seed] [hard bot iterations] [log file]
+int main(int argc, char* argv[])
+{
+	Tournament::Options options;
+	options.gamesCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000;
+	options.threadsCount = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 0;
+	if (argc > 5)
+		options.seed = std::strtoull(argv[5], nullptr, 10);
+
+	Settings& settings = options.settings;
+	settings.withUser = false;
+	settings.botDelay = {};
+	settings.pauseDelay = {};
+	settings.botsNumber = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2;
+	if (argc > 3 && !parseDifficulties(argv[3], settings))
+	{
+		std::cerr << "unknown difficulty in " << argv[3] << ", expected easy, medium or hard" << std::endl;
+		return 1;
+	}
+
+	// games already run in parallel, so the search gets a fixed budget on the game's thread
+	settings.botThinkTime = {};
+	settings.botSearchIterations = argc > 6 ? std::strtoull(argv[6], nullptr, 10) : 200;
+	settings.botSearchThreadsCount = 1;
+
+	std::optional<GameLog> log;
+	if (argc > 7)
+	{
+		log.emplace(argv[7]);
+		if (!log->IsOpen())
+		{
+			std::cerr << "can't open " << argv[7] << std::endl;
+			return 1;
+		}
+		options.log = &*log;
+	}
+
+	const auto result = Tournament::Run(options);
+
+	std::cout << "games: " << result.gamesCount << '\n';
+	std::cout << "threads: " << result.threadsCount << '\n';
+	std::cout << "rounds per game: " << (result.gamesCount ? static_cast<double>(result.roundsCount) / result.gamesCount : 0.) << '\n';
+	for (size_t id = 0; id < result.durakCount.size(); ++id)
+		std::cout << "bot " << id << " durak: " << result.durakCount[id] << '\n';
+	std::cout << "draws: " << result.drawsCount << '\n';
+	std::cout << "interrupted: " << result.interruptedCount << '\n';
+	std::cout << "elapsed: " << result.seconds << " s, " << result.GetGamesPerSecond() << " games/s" << std::endl;
+	return 0;
+}
\ No newline at end of file
@@ -1,13 +1,13 @@
 #include "Bot.h"
-#include <map>
-#include <set>
-#include <thread>
-#include <array>
 #include "Card.h"
+#include "CardSet.hpp"
 #include "Context.h"
+#include "Endgame.h"
 #include "Event.hpp"
+#include "Memory.h"
 #include "Random.hpp"
 #include "Round.h"
+#include "Search.h"
 
 class Bot::Behavior
 {
@@ -15,36 +15,21 @@ public:
 	Behavior(Bot&);
 	virtual ~Behavior() = default;
 
-	static std::unique_ptr<Behavior> Create(Bot&, Settings::Difficulty);
+	static std::unique_ptr<Behavior> Create(Bot&, Settings::Difficulty, const Settings&, EventHandlers&);
 
-	std::optional<Card> PickAttackCard(const Context& context, const Player& defender, const CardFilter& filter) const
+	std::optional<Card> PickAttackCard(const Context& context, const Player& defender, const CardSet& playableCards) const
 	{
-		return pickAttackCard(context, defender, getFilteredCards(filter));
+		return pickAttackCard(context, defender, playableCards);
 	}
 
-	std::optional<Card> PickDefendCard(const Context& context, const Player& attacker, const CardFilter& filter) const
+	std::optional<Card> PickDefendCard(const Context& context, const Player& attacker, const CardSet& playableCards) const
 	{
-		return pickDefendCard(context, attacker, getFilteredCards(filter));
+		return pickDefendCard(context, attacker, playableCards);
 	}
 
 protected:
-	virtual std::optional<Card> pickAttackCard(const Context&, const Player& defender, std::vector<Card>&& filteredCards) const = 0;
-	virtual std::optional<Card> pickDefendCard(const Context&, const Player& attacker, std::vector<Card>&& filteredCards) const = 0;
-
-private:
-	std::vector<Card> getFilteredCards(const CardFilter& filter) const
-	{
-		std::vector<Card> filteredCards;
-		const auto& hand = _owner.GetHand();
-		filteredCards.reserve(hand.GetCardCount());
-		for (size_t i = 0; i < hand.GetCardCount(); ++i)
-		{
-			const Card card = hand.GetCard(i);
-			if (!filter || filter(card))
-				filteredCards.push_back(card);
-		}
-		return filteredCards;
-	}
+	virtual std::optional<Card> pickAttackCard(const Context&, const Player& defender, const CardSet& playableCards) const = 0;
+	virtual std::optional<Card> pickDefendCard(const Context&, const Player& attacker, const CardSet& playableCards) const = 0;
 
 protected:
 	Bot& _owner;
@@ -52,66 +37,9 @@ protected:
 
 namespace
 {
-	class Memory final : public AutoEventHandler
-	{
-	public:
-		const std::set<Card>* GetPlayerCards(Player::Id id) const
-		{
-			auto iter = _playerCards.find(id);
-			return iter != _playerCards.end() ? &iter->second : nullptr;
-		}
-
-		const std::set<Card>& GetDiscardPile() const
-		{
-			return _discardPile;
-		}
-
-	private:
-		void OnPlayerShowTrumpCard(const Player& player, const Card& card) override
-		{
-			_playerCards[player.GetId()].insert(card);
-		}
-
-		void OnPlayerAttack(const Player& player, const Card& card) override
-		{
-			_playerCards[player.GetId()].insert(card);
-		}
-
-		void OnPlayerDefend(const Player& player, const Card& card) override
-		{
-			_playerCards[player.GetId()].insert(card);
-		}
-
-		void OnPlayerDrawRoundCards(const Player& player, const std::vector<Card>& cards) override
-		{
-			_playerCards[player.GetId()].insert(cards.begin(), cards.end());
-
-			for (auto& [playerId, playerCards] : _playerCards)
-			{
-				if (playerId != player.GetId())
-				{
-					for (const auto& card : cards)
-						playerCards.erase(card);
-				}
-			}
-		}
-
-		void OnRoundEnd(const Round& round) override
-		{
-			const auto& roundCards = round.GetCards();
-			_discardPile.insert(roundCards.begin(), roundCards.end());
-
-			for (auto& [playerId, playerCards] : _playerCards)
-			{
-				for (const auto& card : roundCards)
-					playerCards.erase(card);
-			}
-		}
-
-	private:
-		std::map<Player::Id, std::set<Card>> _playerCards;
-		std::set<Card> _discardPile;
-	};
+	// Medium plays the small endgames it can solve quickly
+	constexpr size_t MediumMaxNodesCount = 1 << 8;
+	constexpr size_t MediumMaxCardsCount = 8;
 
 	class EasyBehavior : public Bot::Behavior
 	{
@@ -119,64 +47,75 @@ namespace
 		using Behavior::Behavior;
 
 	protected:
-		std::optional<Card> pickAttackCard(const Context& context, const Player& defender, std::vector<Card>&& filteredCards) const override
+		std::optional<Card> pickAttackCard(const Context& context, const Player& defender, const CardSet& playableCards) const override
 		{
-			return randomPick(filteredCards);
+			return randomPick(context, playableCards);
 		}
 
-		std::optional<Card> pickDefendCard(const Context& context, const Player& attacker, std::vector<Card>&& filteredCards) const override
+		std::optional<Card> pickDefendCard(const Context& context, const Player& attacker, const CardSet& playableCards) const override
 		{
-			return randomPick(filteredCards);
+			return randomPick(context, playableCards);
 		}
 
 	private:
-		static std::optional<Card> randomPick(const std::vector<Card>& filteredCards)
+		static std::optional<Card> randomPick(const Context& context, const CardSet& playableCards)
 		{
-			if (filteredCards.empty())
+			if (playableCards.IsEmpty())
 				return std::nullopt;
 
-			const size_t index = Random::GetNumber(filteredCards.size() - 1);
-			return filteredCards[index];
+			const size_t index = Random::GetNumber(context.GetRandom(), playableCards.GetCount() - 1);
+			return playableCards.GetNth(index);
 		}
 	};
 
 	class MediumBehavior : public EasyBehavior
 	{
 	public:
-		using EasyBehavior::EasyBehavior;
+		explicit MediumBehavior(Bot& owner, const Endgame::Options& endgameOptions = { MediumMaxNodesCount, 1, MediumMaxCardsCount })
+			: EasyBehavior(owner)
+			, _endgame(endgameOptions)
+		{}
 
 	protected:
-		std::optional<Card> pickAttackCard(const Context& context, const Player& defender, std::vector<Card>&& filteredCards) const override
+		std::optional<Card> pickAttackCard(const Context& context, const Player& defender, const CardSet& playableCards) const override
 		{
+			if (const auto solution = _endgame.Solve(context.GetState()))
+				return solution->move.GetCard();
+
 			const auto& deck = context.GetDeck();
 			const double pickTrumpChance = getDiscardDeckRatio(deck);
-			return pickCard(context, pickTrumpChance, std::move(filteredCards));
+			return pickCard(context, pickTrumpChance, playableCards);
 		}
 
-		std::optional<Card> pickDefendCard(const Context& context, const Player& attacker, std::vector<Card>&& filteredCards) const override
+		std::optional<Card> pickDefendCard(const Context& context, const Player& attacker, const CardSet& playableCards) const override
 		{
+			if (const auto solution = _endgame.Solve(context.GetState()))
+				return solution->move.GetCard();
+
 			const auto& deck = context.GetDeck();
 			const double pickTrumpChance = deck.GetCount() <= 10 ? 1. : getDiscardDeckRatio(deck) * 0.8;
-			return pickCard(context, pickTrumpChance, std::move(filteredCards));
+			return pickCard(context, pickTrumpChance, playableCards);
 		}
 
-		static void sort(std::vector<Card>& cards, Card::Suit trumpSuit)
+		static std::optional<Card> getPreferredCard(const CardSet& cards, Card::Suit trumpSuit)
 		{
-			std::array<size_t, static_cast<size_t>(Card::Suit::Count)> suitCount;
-			suitCount.fill(0);
-			for (const Card& card : cards)
-				++suitCount[static_cast<size_t>(card.GetSuit())];
+			const CardSet notTrumps = cards - CardSet::OfSuit(trumpSuit);
+			const auto lowest = notTrumps.IsEmpty() ? cards.GetLowest() : notTrumps.GetLowest(); // trump suit -> low priority
+			if (!lowest)
+				return std::nullopt;
 
-			std::sort(cards.begin(), cards.end(), [trumpSuit, &suitCount](const Card& a, const Card& b)
+			std::optional<Card> preferred;
+			size_t preferredSuitCount = 0;
+			for (const Card card : (notTrumps.IsEmpty() ? cards : notTrumps).GetRank(lowest->GetRank()))
+			{
+				const size_t suitCount = cards.GetSuit(card.GetSuit()).GetCount(); // more common suits -> high priority
+				if (!preferred || suitCount > preferredSuitCount)
 				{
-					if (a.IsTrump(trumpSuit) != b.IsTrump(trumpSuit))
-						return b.IsTrump(trumpSuit); // trump suit -> low priority
-
-					if (a.GetRank() == b.GetRank())
-						return suitCount[static_cast<size_t>(a.GetSuit())] > suitCount[static_cast<size_t>(b.GetSuit())]; // more common suits -> high priority
-
-					return a.GetRank() < b.GetRank();
-				});
+					preferred = card;
+					preferredSuitCount = suitCount;
+				}
+			}
+			return preferred;
 		}
 
 		static double getDiscardDeckRatio(const Deck& deck)
@@ -184,19 +123,20 @@ namespace
 			return static_cast<double>(deck.GetMaxCount() - deck.GetCount()) / deck.GetMaxCount();
 		}
 
+	protected:
+		mutable Endgame _endgame; // takes over once the deck is empty and two players are left
+
 	private:
-		static std::optional<Card> pickCard(const Context& context, double pickTrumpChance, std::vector<Card>&& filteredCards)
+		static std::optional<Card> pickCard(const Context& context, double pickTrumpChance, const CardSet& playableCards)
 		{
-			if (filteredCards.empty())
+			const auto card = getPreferredCard(playableCards, context.GetTrumpSuit());
+			if (!card)
 				return std::nullopt;
 
-			sort(filteredCards, context.GetTrumpSuit());
-			const Card& card = filteredCards.front();
-
-			if (card.IsTrump(context.GetTrumpSuit()))
+			if (card->IsTrump(context.GetTrumpSuit()))
 			{
 				const int chance = static_cast<int>(pickTrumpChance * 100);
-				if (Random::GetNumber(100, 1) > chance)
+				if (Random::GetNumber(context.GetRandom(), 100, 1) > chance)
 					return std::nullopt;
 			}
 			return card;
@@ -206,29 +146,48 @@ namespace
 	class HardBehavior : public MediumBehavior
 	{
 	public:
-		using MediumBehavior::MediumBehavior;
+		HardBehavior(Bot& owner, const Settings& settings, EventHandlers& events)
+			: MediumBehavior(owner, { Endgame::DefaultMaxNodesCount, settings.botSearchThreadsCount })
+			, _memory(owner, events)
+			, _options{ settings.botThinkTime, settings.botSearchIterations, settings.botSearchThreadsCount }
+		{}
 
 	protected:
-		std::optional<Card> pickAttackCard(const Context& context, const Player& defender, std::vector<Card>&& filteredCards) const override
+		std::optional<Card> pickAttackCard(const Context& context, const Player& defender, const CardSet& playableCards) const override
 		{
-			if (const auto* defenderCards = _memory.GetPlayerCards(defender.GetId()))
-			{
-				// TODO
-			}
-			return MediumBehavior::pickAttackCard(context, defender, std::move(filteredCards));
+			return pickCard(context, playableCards);
 		}
 
-		std::optional<Card> pickDefendCard(const Context& context, const Player& attacker, std::vector<Card>&& filteredCards) const override
+		std::optional<Card> pickDefendCard(const Context& context, const Player& attacker, const CardSet& playableCards) const override
+		{
+			return pickCard(context, playableCards);
+		}
+
+	private:
+		std::optional<Card> pickCard(const Context& context, const CardSet& playableCards) const
 		{
-			if (const auto* attackerCards = _memory.GetPlayerCards(attacker.GetId()))
+			if (playableCards.IsEmpty())
+				return std::nullopt;
+
+			// with the deck empty every card is known, the exact answer beats sampling
+			if (const auto solution = _endgame.Solve(context.GetState()))
+				return solution->move.GetCard();
+
+			// the search only takes the bot's own hand from the state, other hidden cards are sampled
+			Search::Beliefs beliefs;
+			for (Player::Id id = 0; id < beliefs.size(); ++id)
 			{
-				// TODO
+				if (id != _owner.GetId())
+					beliefs[id] = { _memory.GetKnownCards(id), _memory.GetImpossibleCards(id, context.GetTrumpSuit()) };
 			}
-			return MediumBehavior::pickDefendCard(context, attacker, std::move(filteredCards));
+
+			const auto move = Search::FindMove(context.GetState(), beliefs, _options, context.GetRandom()());
+			return move.GetCard();
 		}
 
 	private:
-		static inline Memory _memory;
+		Memory _memory;
+		Search::Options _options;
 	};
 }
 
@@ -237,21 +196,21 @@ Bot::Behavior::Behavior(Bot& owner)
 {
 }
 
-std::unique_ptr<Bot::Behavior> Bot::Behavior::Create(Bot& owner, Settings::Difficulty difficulty)
+std::unique_ptr<Bot::Behavior> Bot::Behavior::Create(Bot& owner, Settings::Difficulty difficulty, const Settings& settings, EventHandlers& events)
 {
 	switch (difficulty)
 	{
 	case Settings::Difficulty::Easy:		return std::make_unique<EasyBehavior>(owner);
 	case Settings::Difficulty::Medium:		return std::make_unique<MediumBehavior>(owner);
-	case Settings::Difficulty::Hard:		return std::make_unique<HardBehavior>(owner);
+	case Settings::Difficulty::Hard:		return std::make_unique<HardBehavior>(owner, settings, events);
 	}
 	return nullptr;
 }
 
 
-Bot::Bot(Id id, Settings::Difficulty difficulty)
+Bot::Bot(Id id, Settings::Difficulty difficulty, const Settings& settings, EventHandlers& events)
 	: Player(id)
-	, _behavior(Behavior::Create(*this, difficulty))
+	, _behavior(Behavior::Create(*this, difficulty, settings, events))
 {
 }
 
@@ -259,18 +218,24 @@ Bot::~Bot()
 {
 }
 
-std::optional<Card> Bot::pickAttackCard(const Context& context, const Player& defender, const CardFilter& filter) const
+std::optional<Card> Bot::pickAttackCard(const Context& context, const Player& defender, const CardSet& playableCards) const
 {
-	std::this_thread::sleep_for(std::chrono::seconds(1));
-	if (_behavior)
-		return _behavior->PickAttackCard(context, defender, filter);
-	return std::nullopt;
+	if (!_behavior)
+		return std::nullopt;
+
+	return context.GetPacer().RunBotMove(context, [&]()
+		{
+			return _behavior->PickAttackCard(context, defender, playableCards);
+		});
 }
 
-std::optional<Card> Bot::pickDefendCard(const Context& context, const Player& attacker, const CardFilter& filter) const
+std::optional<Card> Bot::pickDefendCard(const Context& context, const Player& attacker, const CardSet& playableCards) const
 {
-	std::this_thread::sleep_for(std::chrono::seconds(1));
-	if (_behavior)
-		return _behavior->PickDefendCard(context, attacker, filter);
-	return std::nullopt;
+	if (!_behavior)
+		return std::nullopt;
+
+	return context.GetPacer().RunBotMove(context, [&]()
+		{
+			return _behavior->PickDefendCard(context, attacker, playableCards);
+		});
 }
\ No newline at end of file
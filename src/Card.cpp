@@ -1,4 +1,5 @@
 #include "Card.h"
+#include "CardSet.hpp"
 
 Card::Card(Suit suit, Rank rank)
 	: _suit(suit)
@@ -31,10 +32,5 @@ bool Card::IsTrump(Suit trumpSuit) const
 
 bool Card::Beats(const Card& other, Suit trumpSuit) const
 {
-	if (IsTrump(trumpSuit) == other.IsTrump(trumpSuit))
-		return GetSuit() == other.GetSuit() && GetRank() > other.GetRank();
-	else if (IsTrump(trumpSuit) && !other.IsTrump(trumpSuit))
-		return true;
-	else
-		return false;
+	return CardSet::Beating(other, trumpSuit).Contains(*this);
 }
\ No newline at end of file
@@ -1,19 +1,30 @@
 #include "Context.h"
 #include "PlayersGroup.h"
 #include "Player.h"
-#include "Event.hpp"
+#include "IController.h"
+#include "Settings.h"
 
-Context::Context(std::weak_ptr<UI> ui)
-	: _ui(ui)
+Context::Context(std::weak_ptr<IController> controller)
+	: _controller(controller)
+{
+}
+
+Context::~Context()
 {
 }
 
 void Context::Setup(const Settings& settings)
 {
-	_players = std::make_unique<PlayersGroup>(settings);
-	EventHandlers::Get().OnPlayersCreated(*_players);
+	_seed = settings.seed ? *settings.seed : Random::MakeSeed();
+	_random = Random::MakeGenerator(_seed);
+	_deck = Deck(_random);
+	_pacer.Setup(settings);
+
+	_players = std::make_unique<PlayersGroup>(settings, _events);
+	_events.OnPlayersCreated(*_players);
 	_trumpSuit = _deck.GetLast()->GetSuit();
-	_players->DrawCards(_deck, _players->GetUser());
+	_state = GameState(_deck, _players->GetCount());
+	_players->DrawCards(*this, _players->GetUser());
 }
 
 Deck& Context::GetDeck()
@@ -36,12 +47,47 @@ const PlayersGroup& Context::GetPlayers() const
 	return *_players;
 }
 
+GameState& Context::GetState()
+{
+	return _state;
+}
+
+const GameState& Context::GetState() const
+{
+	return _state;
+}
+
+Pacer& Context::GetPacer()
+{
+	return const_cast<Pacer&>(const_cast<const Context*>(this)->GetPacer());
+}
+
+const Pacer& Context::GetPacer() const
+{
+	return _pacer;
+}
+
+EventHandlers& Context::GetEvents()
+{
+	return _events;
+}
+
+Random::Generator& Context::GetRandom() const
+{
+	return _random;
+}
+
+Random::Seed Context::GetSeed() const
+{
+	return _seed;
+}
+
 Card::Suit Context::GetTrumpSuit() const
 {
 	return _trumpSuit;
 }
 
-std::shared_ptr<UI> Context::GetUI() const
+std::shared_ptr<IController> Context::GetController() const
 {
-	return _ui.lock();
+	return _controller.lock();
 }
\ No newline at end of file
@@ -1,7 +1,5 @@
 #include "Deck.h"
 #include <functional>
-#include <algorithm>
-#include "Random.hpp"
 
 namespace
 {
@@ -16,7 +14,7 @@ namespace
 		}
 	}
 
-	inline std::queue<Card> fillDeck()
+	inline std::deque<Card> fillDeck(Random::Generator& generator)
 	{
 		std::deque<Card> deque;
 		forEachCard([&deque](const Card& card)
@@ -24,26 +22,26 @@ namespace
 				deque.push_back(card);
 			});
 
-		std::shuffle(deque.begin(), deque.end(), Random::GetGenerator());
-		return std::queue<Card>(std::move(deque));
+		Random::Shuffle(generator, deque.begin(), deque.end());
+		return deque;
 	}
 }
 
-Deck::Deck()
-	: _queue(fillDeck())
+Deck::Deck(Random::Generator& generator)
+	: _cards(fillDeck(generator))
 {
 }
 
 bool Deck::IsEmpty() const
 {
-	return _queue.empty();
+	return _cards.empty();
 }
 
 std::optional<Card> Deck::GetLast() const
 {
 	if (IsEmpty())
 		return std::nullopt;
-	return _queue.back();
+	return _cards.back();
 }
 
 std::optional<Card> Deck::PopFirst()
@@ -51,14 +49,19 @@ std::optional<Card> Deck::PopFirst()
 	if (IsEmpty())
 		return std::nullopt;
 
-	Card card = _queue.front();
-	_queue.pop();
+	Card card = _cards.front();
+	_cards.pop_front();
 	return card;
 }
 
 size_t Deck::GetCount() const
 {
-	return _queue.size();
+	return _cards.size();
+}
+
+const std::deque<Card>& Deck::GetCards() const
+{
+	return _cards;
 }
 
 size_t Deck::GetMaxCount()
@@ -1,4 +1,5 @@
 ﻿#include "Drawing.h"
+#include <array>
 #include <cmath>
 #include <numbers>
 #include <SFML/Graphics/RenderTarget.hpp>
@@ -6,8 +7,8 @@
 #include <SFML/Graphics/Font.hpp>
 #include <SFML/Graphics/Text.hpp>
 #include "UI.h"
+#include "CardSet.hpp"
 #include "Color.h"
-#include "Deck.h"
 #include "Vector.h"
 
 namespace
@@ -73,20 +74,18 @@ namespace
 
 	inline void drawPointPattern(sf::RenderTarget& target, const sf::Color& color, float width, float height, float step)
 	{
-		sf::VertexArray points(sf::PrimitiveType::Points, 4);
-		setColor(points, color);
-
+		sf::VertexArray points(sf::PrimitiveType::Points);
 		for (float x = 0.f; x < 0.5f * width; x += step)
 		{
 			for (float y = 0.f; y < 0.5f * height; y += step)
 			{
-				points[0].position = { x, y };
-				points[1].position = { -x, y };
-				points[2].position = { -x, -y };
-				points[3].position = { x, -y };
-				target.draw(points);
+				points.append({ { x, y }, color });
+				points.append({ { -x, y }, color });
+				points.append({ { -x, -y }, color });
+				points.append({ { x, -y }, color });
 			}
 		}
+		target.draw(points);
 	}
 
 	inline char getCardCharacter(const Card& card)
@@ -186,6 +185,48 @@ namespace
 		view.move(offset - rotatedOffset);
 	}
 
+	constexpr size_t AtlasColumns = CardSet::RankCount;
+	constexpr size_t AtlasRows = CardSet::SuitCount + 1;
+	constexpr float AtlasPadding = 1.f;
+
+	inline sf::Vector2u getSlotSize(const sf::Vector2f& cardSize)
+	{
+		return { static_cast<unsigned int>(std::ceil(cardSize.x + 2.f * AtlasPadding)), static_cast<unsigned int>(std::ceil(cardSize.y + 2.f * AtlasPadding)) };
+	}
+
+	inline sf::Vector2f getCenter(const sf::FloatRect& rect)
+	{
+		return { rect.left + 0.5f * rect.width, rect.top + 0.5f * rect.height };
+	}
+
+	using Quad = std::array<sf::Vertex, 6>; // two triangles
+
+	inline Quad getQuad(const sf::Vector2f& size, const sf::Transform& transform, const sf::FloatRect& textureRect, const sf::Color& color = sf::Color::White)
+	{
+		const sf::Vector2f half = 0.5f * size;
+		const sf::Vertex corners[] =
+		{
+			{ transform.transformPoint({ -half.x, -half.y }), color, { textureRect.left, textureRect.top } },
+			{ transform.transformPoint({ half.x, -half.y }), color, { textureRect.left + textureRect.width, textureRect.top } },
+			{ transform.transformPoint({ half.x, half.y }), color, { textureRect.left + textureRect.width, textureRect.top + textureRect.height } },
+			{ transform.transformPoint({ -half.x, half.y }), color, { textureRect.left, textureRect.top + textureRect.height } },
+		};
+		return { corners[0], corners[1], corners[2], corners[0], corners[2], corners[3] };
+	}
+
+	// rotates like the views of Screen::Drawing do, but around the card center
+	inline Quad getCardQuad(const sf::FloatRect& atlasRect, const sf::Vector2f& position, float angleDegree)
+	{
+		sf::Transform transform;
+		transform.translate(position).rotate(-angleDegree);
+		return getQuad(atlasRect.getSize(), transform, atlasRect);
+	}
+
+	inline void drawQuad(sf::RenderTarget& target, const Quad& quad, const sf::RenderStates& states = sf::RenderStates::Default)
+	{
+		target.draw(quad.data(), quad.size(), sf::PrimitiveType::Triangles, states);
+	}
+
 	struct ViewGuard
 	{
 	public:
@@ -336,6 +377,81 @@ namespace Screen
 		drawPointPattern(target, Color::LightGrayGreen, card.getSize().x * patternSizeCoeff, card.getSize().y * patternSizeCoeff, card.getSize().x * patternStepCoeff);
 	}
 
+	CardAtlas::CardAtlas()
+		: _cardSize(CloseCard{}.getSize())
+	{
+		const sf::Vector2u slotSize = getSlotSize(_cardSize);
+		_texture.create(slotSize.x * AtlasColumns, slotSize.y * AtlasRows);
+		_texture.clear(sf::Color::Transparent);
+
+		for (size_t i = 0; i < CardSet::MaxCount; ++i)
+		{
+			const ::Card cardInfo = CardSet::GetCard(i);
+			OpenCard card(cardInfo);
+			card.setOrigin(getCenter(GetRect(cardInfo)));
+			_texture.draw(card);
+		}
+
+		CloseCard back;
+		back.setOrigin(getCenter(GetRect(std::nullopt)));
+		_texture.draw(back);
+
+		_texture.display();
+	}
+
+	const CardAtlas& CardAtlas::Get()
+	{
+		static const CardAtlas atlas;
+		return atlas;
+	}
+
+	const sf::Texture& CardAtlas::GetTexture() const
+	{
+		return _texture.getTexture();
+	}
+
+	sf::FloatRect CardAtlas::GetRect(const std::optional<::Card>& card) const
+	{
+		// faces lie rank by column and suit by row, the back starts the row below them
+		if (!card)
+			return getSlotRect(0, CardSet::SuitCount);
+
+		const size_t index = CardSet::GetIndex(*card);
+		return getSlotRect(index / CardSet::SuitCount, index % CardSet::SuitCount);
+	}
+
+	sf::FloatRect CardAtlas::getSlotRect(size_t column, size_t row) const
+	{
+		const sf::Vector2u slotSize = getSlotSize(_cardSize);
+		const sf::Vector2f position{ static_cast<float>(slotSize.x * column), static_cast<float>(slotSize.y * row) };
+		return { position + sf::Vector2f{ AtlasPadding, AtlasPadding }, _cardSize };
+	}
+
+	void CardBatch::Clear()
+	{
+		_vertices.clear();
+	}
+
+	void CardBatch::Add(const std::optional<::Card>& card, const sf::Vector2f& position, float angleDegree)
+	{
+		for (const sf::Vertex& vertex : getCardQuad(CardAtlas::Get().GetRect(card), position, angleDegree))
+			_vertices.append(vertex);
+	}
+
+	size_t CardBatch::GetCount() const
+	{
+		return _vertices.getVertexCount() / std::tuple_size_v<Quad>;
+	}
+
+	void CardBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const
+	{
+		if (_vertices.getVertexCount() == 0)
+			return;
+
+		states.texture = &CardAtlas::Get().GetTexture();
+		target.draw(_vertices, states);
+	}
+
 	void SkipButton::run(sf::RenderTarget& target) const
 	{
 		sf::RectangleShape rect;
@@ -369,36 +485,34 @@ namespace Screen
 		target.draw(cross);
 	}
 
-	Deck::Deck(const ::Deck& deck)
-		: _deck(deck)
+	Deck::Deck(size_t count, const std::optional<::Card>& trumpCard)
+		: _count(count)
+		, _trumpCard(trumpCard)
 	{
 	}
 
 	void Deck::run(sf::RenderTarget& target) const
 	{
-		if (auto lastCard = _deck.GetLast())
-		{
-			Screen::OpenCard openCard(*lastCard);
-			openCard.setOrigin(0.f, -0.5f * openCard.getSize().x);
+		// the cards come from the atlas, nothing is drawn point by point or allocated per frame
+		const CardAtlas& atlas = CardAtlas::Get();
+		sf::RenderStates states;
+		states.texture = &atlas.GetTexture();
 
-			Holder base(std::move(openCard));
-			base.rotate(90.f);
+		const sf::FloatRect backRect = atlas.GetRect(std::nullopt);
+		const sf::Vector2f cardSize = backRect.getSize();
 
-			target.draw(base);
+		if (_count > 0 && _trumpCard)
+		{
+			// lies across under the deck
+			drawQuad(target, getCardQuad(atlas.GetRect(*_trumpCard), { -0.5f * cardSize.x, 0.f }, 90.f), states);
 		}
-		if (_deck.GetCount() > 1)
+		if (_count > 1)
 		{
 			constexpr float deckHeightCoeff = 0.5f;
-			const float deckHeight = static_cast<float>(_deck.GetCount()) * deckHeightCoeff;
-
-			CloseCard firstCard;
-			firstCard.setOrigin(0.f, -deckHeight);
+			const float deckHeight = static_cast<float>(_count) * deckHeightCoeff;
 
-			sf::RectangleShape deck({ firstCard.getSize().x, firstCard.getSize().y + deckHeight });
-			deck.setOrigin(0.5f * deck.getSize());
-			deck.setFillColor(Color::LightGrayGreen);
-			target.draw(deck);
-			target.draw(firstCard);
+			drawQuad(target, getQuad({ cardSize.x, cardSize.y + deckHeight }, sf::Transform::Identity, {}, Color::LightGrayGreen));
+			drawQuad(target, getCardQuad(backRect, { 0.f, -deckHeight }, 0.f), states);
 		}
 	}
 
@@ -430,8 +544,9 @@ namespace Screen
 		target.draw(holder);
 	}
 
-	Text::Text(const sf::String& string)
+	Text::Text(const sf::String& string, unsigned int characterSize)
 		: _string(string)
+		, _characterSize(characterSize)
 	{
 	}
 
@@ -462,7 +577,7 @@ namespace Screen
 
 	sf::Text Text::createText() const
 	{
-		sf::Text text(_string, getFont(), CharacterSize);
+		sf::Text text(_string, getFont(), _characterSize);
 		const auto size = text.getLocalBounds().getSize();
 		text.setOrigin({ 0.5f * size.x, size.y });
 		return text;
@@ -0,0 +1,229 @@
+#include "Endgame.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using MoveMask = GameState::MoveMask;
+	using Value = int8_t;
+	using Moves = std::array<uint8_t, CardSet::MaxCount + 1>;
+
+	constexpr size_t NoCardMove = GameState::NoCardMove;
+	constexpr size_t MinTableCapacity = size_t{ 1 } << 10;
+	constexpr size_t MaxTableCapacity = size_t{ 1 } << 16;
+	constexpr uint8_t NoMove = 0xFF;
+
+	constexpr Value WinValue = static_cast<Value>(Endgame::Result::Win);
+	constexpr Value LossValue = static_cast<Value>(Endgame::Result::Loss);
+
+	// the move from the table first, then cheap cards before trumps, giving up the turn last
+	size_t getOrderedMoves(const GameState& state, uint8_t hashMove, Moves& moves)
+	{
+		const MoveMask legalMoves = state.GetLegalMoves();
+		const MoveMask trumps = CardSet::OfSuit(state.GetTrumpSuit()).GetMask();
+		size_t count = 0;
+
+		if (hashMove != NoMove && (legalMoves >> hashMove) & 1)
+			moves[count++] = hashMove;
+
+		const MoveMask noCardMove = MoveMask{ 1 } << NoCardMove;
+		for (const MoveMask group : { legalMoves & ~trumps & ~noCardMove, legalMoves & trumps, legalMoves & noCardMove })
+		{
+			for (MoveMask mask = group; mask; mask &= mask - 1)
+			{
+				const auto move = static_cast<uint8_t>(std::countr_zero(mask));
+				if (move != hashMove)
+					moves[count++] = move;
+			}
+		}
+		return count;
+	}
+}
+
+class Endgame::Worker final
+{
+public:
+	Worker(Table& table, GameState::PlayerIndex self, size_t maxNodesCount, const std::atomic<bool>& stop)
+		: _table(table)
+		, _self(self)
+		, _maxNodesCount(maxNodesCount)
+		, _stop(stop)
+	{}
+
+	// null window searches: first whether the player can win, then whether they can hold a draw.
+	// Helpers start from other root moves, so that the threads fill different parts of the table
+	std::optional<Solution> Run(GameState& root, size_t firstMove)
+	{
+		Moves moves;
+		const size_t movesCount = getOrderedMoves(root, NoMove, moves);
+		std::rotate(moves.begin(), moves.begin() + firstMove % movesCount, moves.begin() + movesCount);
+
+		for (const Value target : { WinValue, Value{ 0 } })
+		{
+			for (size_t i = 0; i < movesCount; ++i)
+			{
+				const auto move = root.GetMove(moves[i]);
+				const auto undo = root.ApplyMove(move);
+				const Value value = solve(root, target - 1, target);
+				root.UndoMove(undo);
+
+				if (_aborted)
+					return std::nullopt;
+
+				if (value >= target)
+					return Solution{ move, static_cast<Result>(target) };
+			}
+		}
+		return Solution{ root.GetMove(moves[0]), Result::Loss };
+	}
+
+private:
+	// minimax for the player who asked, the table stores values for the player to move
+	Value solve(GameState& state, Value alpha, Value beta)
+	{
+		if (state.GetPhase() == GameState::Phase::Over)
+			return getValue(state);
+
+		if (++_nodesCount > _maxNodesCount || _stop.load(std::memory_order_relaxed))
+		{
+			_aborted = true;
+			return 0;
+		}
+
+		const bool maximizing = state.GetCurrentPlayer() == _self;
+		const GameState::Key key = state.GetKey();
+		uint8_t hashMove = NoMove;
+		if (const auto entry = _table.find(key); entry && entry->bound != Bound::None)
+		{
+			const Value value = maximizing ? entry->value : -entry->value;
+			const bool lower = entry->bound == (maximizing ? Bound::Lower : Bound::Upper);
+			const bool upper = entry->bound == (maximizing ? Bound::Upper : Bound::Lower);
+			if (entry->bound == Bound::Exact || (lower && value >= beta) || (upper && value <= alpha))
+				return value;
+			hashMove = entry->move;
+		}
+
+		Moves moves;
+		const size_t movesCount = getOrderedMoves(state, hashMove, moves);
+
+		const Value originalAlpha = alpha;
+		const Value originalBeta = beta;
+		Value best = maximizing ? LossValue - 1 : WinValue + 1;
+		uint8_t bestMove = moves[0];
+
+		for (size_t i = 0; i < movesCount && alpha < beta; ++i)
+		{
+			const auto undo = state.ApplyMove(state.GetMove(moves[i]));
+			const Value value = solve(state, alpha, beta);
+			state.UndoMove(undo);
+
+			if (_aborted)
+				return 0;
+
+			if (maximizing ? value > best : value < best)
+			{
+				best = value;
+				bestMove = moves[i];
+			}
+
+			if (maximizing)
+				alpha = std::max(alpha, best);
+			else
+				beta = std::min(beta, best);
+		}
+
+		const Bound bound = best <= originalAlpha ? Bound::Upper : best >= originalBeta ? Bound::Lower : Bound::Exact;
+		Entry entry;
+		entry.value = maximizing ? best : -best;
+		entry.bound = maximizing || bound == Bound::Exact ? bound : bound == Bound::Lower ? Bound::Upper : Bound::Lower;
+		entry.move = bestMove;
+		_table.store(key, entry);
+		return best;
+	}
+
+	Value getValue(const GameState& state) const
+	{
+		if (state.IsInGame(_self))
+			return LossValue; // durak
+		return state.GetPlayersCount() > 0 ? WinValue : 0;
+	}
+
+private:
+	Table& _table;
+	const GameState::PlayerIndex _self;
+	const size_t _maxNodesCount;
+	const std::atomic<bool>& _stop;
+	size_t _nodesCount = 0;
+	bool _aborted = false;
+};
+
+Endgame::Endgame()
+	: Endgame(Options{})
+{
+}
+
+Endgame::Endgame(const Options& options)
+	: _options(options)
+	, _maxCardsCount(std::min(options.maxCardsCount, MaxCardsCount))
+{
+}
+
+bool Endgame::IsSolvable(const GameState& state)
+{
+	return state.GetPhase() != GameState::Phase::Over && state.GetDeckCount() == 0 && state.GetPlayersCount() == 2;
+}
+
+std::optional<Endgame::Solution> Endgame::Solve(const GameState& state)
+{
+	if (!IsSolvable(state))
+		return std::nullopt;
+
+	size_t cardsCount = 0;
+	for (GameState::PlayerIndex player = 0; player < GameState::MaxPlayersCount; ++player)
+		cardsCount += state.GetHand(player).GetCount();
+	if (cardsCount > _maxCardsCount)
+		return std::nullopt;
+
+	// a few times the nodes of a search, the table keeps what the previous moves found
+	if (!_table)
+		_table.emplace(std::clamp(std::bit_ceil(4 * _options.maxNodesCount), MinTableCapacity, MaxTableCapacity));
+
+	GameState root = state;
+	const GameState::PlayerIndex self = root.GetCurrentPlayer();
+
+	// only what the player can see is used: the opponent holds every card that isn't anywhere else
+	const CardSet hiddenCards = ~(root.GetHand(self) | root.GetTableCards() | root.GetDiscardPile());
+	for (GameState::PlayerIndex player = 0; player < GameState::MaxPlayersCount; ++player)
+	{
+		if (player != self && root.IsInGame(player))
+			root.SetHand(player, hiddenCards);
+	}
+
+	// lazy SMP: helpers search the same position and share what they find through the table
+	const size_t threadsCount = std::max<size_t>(_options.threadsCount ? _options.threadsCount : std::thread::hardware_concurrency(), 1);
+	std::atomic<bool> stop = false;
+	std::vector<std::thread> helpers;
+	helpers.reserve(threadsCount - 1);
+	for (size_t i = 1; i < threadsCount; ++i)
+	{
+		helpers.emplace_back([this, state = root, &stop, self, i]() mutable
+			{
+				Worker(*_table, self, _options.maxNodesCount, stop).Run(state, i);
+			});
+	}
+
+	const std::atomic<bool> never = false;
+	auto solution = Worker(*_table, self, _options.maxNodesCount, never).Run(root, 0);
+
+	stop = true;
+	for (auto& helper : helpers)
+		helper.join();
+
+	if (!solution)
+		_maxCardsCount = cardsCount - 1;
+	return solution;
+}
\ No newline at end of file
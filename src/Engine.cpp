@@ -0,0 +1,68 @@
+#include "Engine.h"
+#include "Context.h"
+#include "PlayersGroup.h"
+#include "Round.h"
+
+Player* Engine::FindFirstPlayer(Context& context)
+{
+	const auto& players = context.GetPlayers();
+	const Card::Suit trumpSuit = context.GetTrumpSuit();
+	std::optional<std::pair<Player*, Card>> firstPlayer;
+
+	players.ForEach([&](Player* player)
+		{
+			const auto card = player->FindLowestTrumpCard(trumpSuit);
+			if (card)
+			{
+				context.GetEvents().OnPlayerShowTrumpCard(*player, *card);
+
+				if (!firstPlayer || card->GetRank() < firstPlayer->second.GetRank())
+					firstPlayer.emplace(player, *card);
+			}
+
+			return firstPlayer && firstPlayer->second.GetRank() == Card::Rank::Min;
+		});
+
+	return firstPlayer ? firstPlayer->first : players.GetFirst();
+}
+
+Engine::Result Engine::Run(Context& context, size_t maxRoundsCount)
+{
+	Result result;
+
+	Player* firstPlayer = FindFirstPlayer(context);
+	if (!firstPlayer)
+		return result;
+
+	context.GetState().Start(firstPlayer->GetId());
+
+	auto round = std::make_unique<Round>(*firstPlayer, context.GetPlayers().GetDefender(*firstPlayer));
+	while (round)
+	{
+		if (result.roundsCount == maxRoundsCount)
+		{
+			// bots can repeat the same takes forever once the deck is empty
+			result.interrupted = true;
+			return result;
+		}
+
+		round = round->Run(context);
+		++result.roundsCount;
+	}
+
+	size_t playersWithCards = 0;
+	context.GetPlayers().ForEach([&](Player* player)
+		{
+			if (!player->GetHand().IsEmpty())
+			{
+				result.durak = player->GetId();
+				++playersWithCards;
+			}
+			return false;
+		});
+
+	if (playersWithCards != 1)
+		result.durak.reset();
+
+	return result;
+}
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include "Game.h"
+#include <atomic>
+#include <cstdlib>
+#include <optional>
 #include <thread>
 #include <SFML/System/Clock.hpp>
 #include "Context.h"
-#include "Round.h"
+#include "Engine.h"
+#include "GameLog.h"
+#include "Replay.h"
 #include "UI.h"
 #include "Event.hpp"
 #include "PlayersGroup.h"
@@ -10,32 +15,39 @@
 
 namespace
 {
-	inline Player* findFirstPlayer(const PlayersGroup& players, Card::Suit trumpSuit)
-	{
-		std::optional<std::pair<Player*, Card>> firstPlayer;
-
-		players.ForEach([&firstPlayer, trumpSuit](Player* player)
-			{
-				const auto card = player->FindLowestTrumpCard(trumpSuit);
-				if (card)
-				{
-					EventHandlers::Get().OnPlayerShowTrumpCard(*player, *card);
-
-					if (!firstPlayer || card->GetRank() < firstPlayer->second.GetRank())
-						firstPlayer.emplace(player, *card);
-				}
-
-				return firstPlayer && firstPlayer->second.GetRank() == Card::Rank::Min;
-			});
+	constexpr const char* LogName = "durak.log"; // every game played is appended to it
 
-		return firstPlayer ? firstPlayer->first : players.GetUser();
+	// the user data directory, the log doesn't depend on where the game is started from. Empty if there's none
+	inline std::filesystem::path getLogPath()
+	{
+#ifdef _WIN32
+		const char* dataDirectory = std::getenv("LOCALAPPDATA");
+		const char* subdirectory = "durak";
+#else
+		const char* dataDirectory = std::getenv("XDG_DATA_HOME");
+		const char* subdirectory = "durak";
+		if (!dataDirectory || !*dataDirectory)
+		{
+			dataDirectory = std::getenv("HOME");
+			subdirectory = ".local/share/durak";
+		}
+#endif
+		if (!dataDirectory || !*dataDirectory)
+			return {};
+
+		const auto directory = std::filesystem::path(dataDirectory) / subdirectory;
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		return error ? std::filesystem::path() : directory / LogName;
 	}
 
 	class UIEventHandler final : public AutoEventHandler
 	{
 	public:
-		UIEventHandler(std::weak_ptr<Context> context)
-			: _context(context)
+		UIEventHandler(const std::shared_ptr<Context>& context, std::weak_ptr<UI> ui)
+			: AutoEventHandler(context->GetEvents())
+			, _context(context)
+			, _ui(ui)
 		{
 		}
 
@@ -47,11 +59,11 @@ namespace
 		{
 			callUI([&](UI& ui, const Context& context) { ui.OnPlayerDefend(context, player, card); });
 		}
-		void OnPlayerDrawDeckCards(const Player& player, const std::vector<Card>& cards) override
+		void OnPlayerDrawDeckCards(const Player& player, const CardSet& cards) override
 		{
 			callUI([&](UI& ui, const Context& context) { ui.OnPlayerDrawDeckCards(context, player, cards); });
 		}
-		void OnPlayerDrawRoundCards(const Player& player, const std::vector<Card>& cards) override
+		void OnPlayerDrawRoundCards(const Player& player, const CardSet& cards) override
 		{
 			callUI([&](UI& ui, const Context& context) { ui.OnPlayerDrawRoundCards(context, player, cards); });
 		}
@@ -89,40 +101,103 @@ namespace
 		void callUI(const T& callback)
 		{
 			auto actualContext = _context.lock();
-			if (auto ui = actualContext ? actualContext->GetUI() : nullptr)
+			if (auto ui = actualContext ? _ui.lock() : nullptr)
 				callback(*ui, *actualContext);
 		}
 
 	private:
 		std::weak_ptr<Context> _context;
+		std::weak_ptr<UI> _ui;
 	};
 
+	// headless, posts everything to the UI and waits only for the user picks
 	inline void gameLoop(std::shared_ptr<UI> ui)
 	{
-		{
-			constexpr unsigned int framerate = 60;
-
-			auto& window = ui->GetWindow();
-			window.setActive(true);
-			window.setFramerateLimit(framerate);
-		}
-
 		auto context = std::make_shared<Context>(ui);
-		UIEventHandler uiEventHandler(context);
+		UIEventHandler uiEventHandler(context, ui);
 
 		Settings settings;
-		EventHandlers::Get().OnStartGame();
+		context->GetEvents().OnStartGame();
 		ui->SetSettings(*context, settings);
+
+		// the game is played without recording when the log can't be opened
+		const auto logPath = getLogPath();
+		std::optional<GameLog> log;
+		std::optional<GameLog::Batch> batch;
+		std::optional<GameLog::Recorder> recorder;
+		if (!logPath.empty())
+			log.emplace(logPath);
+		if (log && log->IsOpen())
+		{
+			batch.emplace(*log);
+			recorder.emplace(*batch, *context, settings);
+		}
 		context->Setup(settings);
+		Engine::Run(*context);
+	}
+
+	// plays the recorded game back through the same handler, at the pace of the replay
+	inline void replayLoop(std::shared_ptr<UI> ui, std::shared_ptr<Context> context, std::shared_ptr<Replay> replay)
+	{
+		UIEventHandler uiEventHandler(context, ui);
+		replay->Run();
+	}
+
+	// owns the window drawing, the frame rate doesn't depend on the game or the input
+	inline void renderLoop(std::shared_ptr<UI> ui, const std::atomic<bool>& running)
+	{
+		constexpr unsigned int framerate = 60;
+
+		auto& window = ui->GetWindow();
+		window.setActive(true);
+		window.setFramerateLimit(framerate);
+
+		while (running)
+			ui->Update();
+
+		window.setActive(false);
+	}
+
+	// the window is polled by the thread that created it, the game is stopped while the frames are still drawn
+	template<typename F, typename S>
+	inline void runWindow(const std::shared_ptr<UI>& ui, const F& onInput, const S& onClose)
+	{
+		auto& window = ui->GetWindow();
+		window.setActive(false);
 
-		Player* firstPlayer = findFirstPlayer(context->GetPlayers(), context->GetTrumpSuit());
-		if (!firstPlayer)
-			return;
+		std::atomic<bool> running = true;
+		std::thread render(&renderLoop, ui, std::cref(running));
 
-		auto round = std::make_unique<Round>(*firstPlayer, context->GetPlayers().GetDefender(*firstPlayer));
-		while (round)
+		for (auto event = sf::Event{}; window.waitEvent(event);)
 		{
-			round = round->Run(*context);
+			if (event.type == sf::Event::Closed)
+				break;
+
+			onInput(event);
+			ui->HandleEvent(event);
+		}
+
+		onClose();
+		running = false;
+		ui->Wake();
+		render.join();
+		ui->CloseWindow();
+	}
+
+	inline std::optional<Replay::Command> getReplayCommand(const sf::Event& event)
+	{
+		if (event.type != sf::Event::KeyPressed)
+			return std::nullopt;
+
+		switch (event.key.code)
+		{
+		case sf::Keyboard::Space:	return Replay::Command::Pause;
+		case sf::Keyboard::Enter:	return Replay::Command::Step;
+		case sf::Keyboard::Left:	return Replay::Command::Back;
+		case sf::Keyboard::Right:	return Replay::Command::Forward;
+		case sf::Keyboard::Up:		return Replay::Command::Faster;
+		case sf::Keyboard::Down:	return Replay::Command::Slower;
+		default:					return std::nullopt;
 		}
 	}
 }
@@ -130,23 +205,42 @@ namespace
 void Game::Run()
 {
 	auto ui = std::make_shared<UI>("durak", 500, 500);
-	ui->GetWindow().setActive(false);
 
 	std::thread game(&gameLoop, ui);
 	game.detach();
 
-	while (ui->GetWindow().isOpen())
-	{
-		auto& window = ui->GetWindow();
-		for (auto event = sf::Event{}; window.pollEvent(event);)
+	runWindow(ui, [](const sf::Event&) {}, []() {});
+}
+
+void Game::Run(const std::filesystem::path& log, size_t gameIndex)
+{
+	auto context = std::make_shared<Context>();
+	std::shared_ptr<Replay> replay;
+
+	const GameLog::Reader reader(log);
+	size_t index = 0;
+	reader.ForEachGame([&](const GameLog::Game& game)
 		{
-			if (event.type == sf::Event::Closed)
-			{
-				ui->CloseWindow();
-				return;
-			}
+			if (index++ != gameIndex)
+				return false;
 
-			ui->HandleEvent(event);
-		}
-	}
+			replay = std::make_shared<Replay>(*context, game);
+			return true;
+		});
+
+	if (!replay)
+		return;
+
+	auto ui = std::make_shared<UI>("durak replay", 500, 500);
+	std::thread game(&replayLoop, ui, context, replay);
+
+	runWindow(ui, [&replay](const sf::Event& event)
+		{
+			if (const auto command = getReplayCommand(event))
+				replay->Post(*command);
+		}, [&replay, &game]()
+		{
+			replay->Post(Replay::Command::Stop);
+			game.join();
+		});
 }
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include "GameLog.h"
+#include <cstring>
+#include "Context.h"
+#include "Round.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// the numbers are little endian whatever the machine is, the log can be read elsewhere
+	template<typename T>
+	inline void writeNumber(uint8_t* data, T value)
+	{
+		for (size_t i = 0; i < sizeof(T); ++i)
+			data[i] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i));
+	}
+
+	template<typename T>
+	inline T readNumber(const uint8_t* data)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < sizeof(T); ++i)
+			value |= static_cast<uint64_t>(data[i]) << (8 * i);
+		return static_cast<T>(value);
+	}
+
+	inline uint8_t getIndex(const Card& card)
+	{
+		return static_cast<uint8_t>(CardSet::GetIndex(card));
+	}
+
+	// maps the file read only, the view outlives the handles
+	inline const uint8_t* mapFile(const std::filesystem::path& path, size_t& size)
+	{
+#ifdef _WIN32
+		const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return nullptr;
+
+		LARGE_INTEGER fileSize{};
+		const void* data = nullptr;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			if (const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+			{
+				data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+
+		size = data ? static_cast<size_t>(fileSize.QuadPart) : 0;
+		return static_cast<const uint8_t*>(data);
+#else
+		const int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return nullptr;
+
+		struct stat status{};
+		void* data = MAP_FAILED;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+		{
+			data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+			if (data != MAP_FAILED)
+				madvise(data, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+		}
+		close(file);
+
+		if (data == MAP_FAILED)
+			return nullptr;
+
+		size = static_cast<size_t>(status.st_size);
+		return static_cast<const uint8_t*>(data);
+#endif
+	}
+
+	inline void unmapFile(const uint8_t* data, size_t size)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+#else
+		munmap(const_cast<uint8_t*>(data), size);
+#endif
+	}
+}
+
+GameLog::GameLog(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+	_file = _wfopen(path.c_str(), L"ab");
+#else
+	_file = std::fopen(path.c_str(), "ab");
+#endif
+	if (!_file)
+		return;
+
+	std::setvbuf(_file, nullptr, _IOFBF, BufferSize);
+	std::fseek(_file, 0, SEEK_END);
+	if (std::ftell(_file) == 0)
+	{
+		std::fwrite(Magic, 1, sizeof(Magic), _file);
+		std::fflush(_file);
+	}
+}
+
+GameLog::~GameLog()
+{
+	if (_file)
+		std::fclose(_file);
+}
+
+bool GameLog::IsOpen() const
+{
+	return _file != nullptr;
+}
+
+void GameLog::Append(const uint8_t* data, size_t size)
+{
+	std::lock_guard lock(_mutex);
+	if (!_file)
+		return;
+
+	std::fwrite(data, 1, size, _file);
+}
+
+void GameLog::Flush()
+{
+	std::lock_guard lock(_mutex);
+	if (_file)
+		std::fflush(_file);
+}
+
+GameLog::Reader::Reader(const std::filesystem::path& path)
+{
+	_data = mapFile(path, _size);
+	if (_data && (_size < sizeof(Magic) || std::memcmp(_data, Magic, sizeof(Magic)) != 0))
+	{
+		unmapFile(_data, _size);
+		_data = nullptr;
+		_size = 0;
+	}
+}
+
+GameLog::Reader::~Reader()
+{
+	if (_data)
+		unmapFile(_data, _size);
+}
+
+bool GameLog::Reader::IsOpen() const
+{
+	return _data != nullptr;
+}
+
+GameLog::Header GameLog::Reader::readHeader(const uint8_t* data)
+{
+	Header header;
+	header.eventsSize = readNumber<uint32_t>(data);
+	header.seed = readNumber<Random::Seed>(data + 4);
+	for (size_t id = 0; id < header.difficulties.size(); ++id)
+		header.difficulties[id] = static_cast<Settings::Difficulty>(data[12 + id]);
+	data += 12 + header.difficulties.size();
+	header.botsNumber = data[0];
+	header.withUser = data[1] != 0;
+	header.trumpCard = data[2];
+	return header;
+}
+
+GameLog::Batch::Batch(GameLog& log)
+	: _log(log)
+{
+	_data.reserve(2 * Capacity); // the game that fills it fits too, most of the time
+}
+
+GameLog::Batch::~Batch()
+{
+	if (!_data.empty())
+		_log.Append(_data.data(), _data.size());
+}
+
+void GameLog::Batch::commit()
+{
+	if (_data.size() < Capacity)
+		return;
+
+	_log.Append(_data.data(), _data.size());
+	_data.clear();
+}
+
+GameLog::Recorder::Recorder(Batch& batch, Context& context, const Settings& settings)
+	: AutoEventHandler(context.GetEvents())
+	, _batch(batch)
+	, _context(context)
+{
+	_header.difficulties.fill(Settings::Difficulty::Count);
+	const size_t firstBot = settings.withUser ? 1 : 0;
+	for (size_t i = 0; i < settings.botsNumber && firstBot + i < _header.difficulties.size(); ++i)
+		_header.difficulties[firstBot + i] = settings.GetBotDifficulty(i);
+	_header.botsNumber = static_cast<uint8_t>(settings.botsNumber);
+	_header.withUser = settings.withUser;
+}
+
+GameLog::Recorder::~Recorder()
+{
+	finish();
+}
+
+void GameLog::Recorder::OnPlayerAttack(const Player& player, const Card& card)
+{
+	add(EventType::Attack, player, getIndex(card));
+}
+
+void GameLog::Recorder::OnPlayerDefend(const Player& player, const Card& card)
+{
+	add(EventType::Defend, player, getIndex(card));
+}
+
+void GameLog::Recorder::OnPlayerDrawDeckCards(const Player& player, const CardSet& cards)
+{
+	for (const Card& card : cards)
+		add(EventType::DrawDeckCard, player, getIndex(card));
+}
+
+void GameLog::Recorder::OnPlayerDrawRoundCards(const Player& player, const CardSet& cards)
+{
+	for (const Card& card : cards)
+		add(EventType::DrawRoundCard, player, getIndex(card));
+}
+
+void GameLog::Recorder::OnRoundStart(const Round& round)
+{
+	add(EventType::RoundStart, round.GetAttacker(), round.GetDefender().GetId());
+}
+
+void GameLog::Recorder::OnRoundEnd(const Round& round)
+{
+	add(EventType::RoundEnd, round.GetAttacker());
+}
+
+// the context is set up, so the seed and the deck are known. A context set up again starts another game
+void GameLog::Recorder::OnPlayersCreated(const PlayersGroup&)
+{
+	finish();
+	_header.seed = _context.GetSeed();
+	_header.trumpCard = getIndex(*_context.GetDeck().GetLast());
+	_start = _batch._data.size();
+	_batch._data.resize(_start + HeaderSize);
+}
+
+void GameLog::Recorder::OnPlayerShowTrumpCard(const Player& player, const Card& card)
+{
+	add(EventType::ShowTrumpCard, player, getIndex(card));
+}
+
+void GameLog::Recorder::OnUserWin(const Player& user)
+{
+	add(EventType::UserWin, user);
+}
+
+void GameLog::Recorder::OnUserLose(const Player& opponent)
+{
+	add(EventType::UserLose, opponent);
+}
+
+void GameLog::Recorder::add(EventType type, const Player& player)
+{
+	if (_start != NoGame)
+		_batch._data.push_back(static_cast<uint8_t>(static_cast<uint8_t>(type) << 4 | player.GetId()));
+}
+
+void GameLog::Recorder::add(EventType type, const Player& player, uint8_t value)
+{
+	add(type, player);
+	if (_start != NoGame)
+		_batch._data.push_back(value);
+}
+
+void GameLog::Recorder::finish()
+{
+	if (_start == NoGame)
+		return;
+
+	uint8_t* header = _batch._data.data() + _start;
+	writeNumber(header, static_cast<uint32_t>(_batch._data.size() - _start - HeaderSize));
+	writeNumber(header + 4, _header.seed);
+	for (size_t id = 0; id < _header.difficulties.size(); ++id)
+		header[12 + id] = static_cast<uint8_t>(_header.difficulties[id]);
+	header += 12 + _header.difficulties.size();
+	header[0] = _header.botsNumber;
+	header[1] = _header.withUser ? 1 : 0;
+	header[2] = _header.trumpCard;
+
+	_start = NoGame;
+	_batch.commit();
+}
\ No newline at end of file
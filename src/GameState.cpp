@@ -0,0 +1,393 @@
+#include "GameState.h"
+#include <algorithm>
+#include <bit>
+#include "Deck.h"
+#include "Random.hpp"
+
+namespace
+{
+	// places with keys: the hands first, then the table and the deck
+	constexpr size_t AttackPlace = GameState::MaxPlayersCount;
+	constexpr size_t DefendPlace = AttackPlace + 1;
+	constexpr size_t DeckPlace = DefendPlace + 1;
+	constexpr size_t PlacesCount = DeckPlace + 1;
+
+	constexpr Random::Seed ZobristSeed = 0xD0BA7E5C0DEull;
+	constexpr Random::Seed HeaderSeed = Random::MakeSeed(ZobristSeed, CardSet::MaxCount * PlacesCount);
+
+	constexpr auto CardKeys = []()
+		{
+			std::array<std::array<GameState::Key, PlacesCount>, CardSet::MaxCount> keys{};
+			for (size_t card = 0; card < CardSet::MaxCount; ++card)
+			{
+				for (size_t place = 0; place < PlacesCount; ++place)
+					keys[card][place] = Random::MakeSeed(ZobristSeed, card * PlacesCount + place);
+			}
+			return keys;
+		}();
+}
+
+GameState::Move::Move(Type type, uint8_t card)
+	: _type(type)
+	, _card(card)
+{
+}
+
+GameState::Move GameState::Move::Play(const Card& card)
+{
+	return Move(Type::Play, static_cast<uint8_t>(CardSet::GetIndex(card)));
+}
+
+GameState::Move GameState::Move::Pass()
+{
+	return Move(Type::Pass);
+}
+
+GameState::Move GameState::Move::Take()
+{
+	return Move(Type::Take);
+}
+
+std::optional<Card> GameState::Move::GetCard() const
+{
+	if (_type != Type::Play)
+		return std::nullopt;
+	return CardSet::GetCard(_card);
+}
+
+GameState::Undo::Undo(const Header& header, const CardSet& attackCards, const CardSet& defendCards, Key cardsKey, const Move& move)
+	: _header(header)
+	, _attackCards(attackCards)
+	, _defendCards(defendCards)
+	, _cardsKey(cardsKey)
+	, _move(move)
+{
+}
+
+GameState::GameState(const Deck& deck, size_t playersCount)
+	: _deckCount(static_cast<uint8_t>(deck.GetCount()))
+	, _trumpSuit(deck.GetLast()->GetSuit())
+{
+	std::transform(deck.GetCards().begin(), deck.GetCards().end(), _deck.begin(), [](const Card& card)
+		{
+			return static_cast<uint8_t>(CardSet::GetIndex(card));
+		});
+
+	for (size_t i = 0; i < _deckCount; ++i)
+		_cardsKey ^= CardKeys[_deck[i]][DeckPlace];
+
+	playersCount = std::min(playersCount, MaxPlayersCount);
+	_header.playersMask = static_cast<uint8_t>((1u << playersCount) - 1);
+
+	// same order as PlayersGroup::DrawCards
+	for (PlayerIndex player = 0; player < playersCount && _header.deckIndex < _deckCount; ++player)
+		drawCards(player);
+}
+
+void GameState::Start(PlayerIndex attacker)
+{
+	startRound(attacker);
+}
+
+GameState::Undo GameState::ApplyMove(const Move& move)
+{
+	Undo undo(_header, _attackCards, _defendCards, _cardsKey, move);
+	const auto card = move.GetCard();
+
+	switch (_header.phase)
+	{
+	case Phase::Attack:
+		if (card)
+		{
+			const PlayerIndex attacker = getAttackPlayer(_header.turn);
+			_hands[attacker].Remove(*card);
+			_attackCards.Add(*card);
+			toggleCards(CardSet::Of(*card), attacker);
+			toggleCards(CardSet::Of(*card), AttackPlace);
+			_header.lastAttackCard = static_cast<uint8_t>(CardSet::GetIndex(*card));
+			_header.phase = Phase::Defend;
+		}
+		else if (++_header.turn == GetPlayersCount() - 1)
+		{
+			endRound(false);
+		}
+		break;
+
+	case Phase::Defend:
+		if (card)
+		{
+			_hands[_header.defender].Remove(*card);
+			_defendCards.Add(*card);
+			toggleCards(CardSet::Of(*card), _header.defender);
+			toggleCards(CardSet::Of(*card), DefendPlace);
+			_header.turn = 0;
+			_header.phase = Phase::Attack;
+
+			if (_attackCards.GetCount() == _header.attacksLimit)
+				endRound(false);
+		}
+		else
+		{
+			_hands[_header.defender].Add(GetTableCards());
+			toggleCards(GetTableCards(), _header.defender);
+			endRound(true);
+		}
+		break;
+
+	case Phase::Over:
+		break;
+	}
+
+	return undo;
+}
+
+void GameState::UndoMove(const Undo& undo)
+{
+	// cards drawn from the deck can only be in hands, so they are removed from all of them
+	CardSet drawnCards;
+	for (size_t i = undo._header.deckIndex; i < _header.deckIndex; ++i)
+		drawnCards.Add(CardSet::GetCard(_deck[i]));
+
+	if (!drawnCards.IsEmpty())
+	{
+		for (CardSet& hand : _hands)
+			hand.Remove(drawnCards);
+	}
+
+	if (undo._move.GetType() == Move::Type::Take)
+		_hands[undo._header.defender].Remove(undo._attackCards | undo._defendCards);
+
+	_header = undo._header;
+	_attackCards = undo._attackCards;
+	_defendCards = undo._defendCards;
+	_cardsKey = undo._cardsKey;
+
+	if (const auto card = undo._move.GetCard())
+		_hands[GetCurrentPlayer()].Add(*card);
+}
+
+GameState::Phase GameState::GetPhase() const
+{
+	return _header.phase;
+}
+
+GameState::PlayerIndex GameState::GetCurrentPlayer() const
+{
+	return _header.phase == Phase::Defend ? _header.defender : getAttackPlayer(_header.turn);
+}
+
+GameState::PlayerIndex GameState::GetAttacker() const
+{
+	return _header.attacker;
+}
+
+GameState::PlayerIndex GameState::GetDefender() const
+{
+	return _header.defender;
+}
+
+size_t GameState::GetPlayersCount() const
+{
+	return static_cast<size_t>(std::popcount(_header.playersMask));
+}
+
+bool GameState::IsInGame(PlayerIndex player) const
+{
+	return (_header.playersMask >> player) & 1;
+}
+
+GameState::Key GameState::GetKey() const
+{
+	// the last attack card only matters while it's being defended
+	const uint64_t lastAttackCard = _header.phase == Phase::Defend ? _header.lastAttackCard : 0;
+	const uint64_t header = uint64_t{ _header.playersMask }
+		| (uint64_t{ _header.attacker } << 8)
+		| (uint64_t{ _header.defender } << 16)
+		| (uint64_t{ _header.turn } << 24)
+		| (uint64_t{ _header.attacksLimit } << 32)
+		| (lastAttackCard << 40)
+		| (static_cast<uint64_t>(_header.phase) << 48)
+		| (static_cast<uint64_t>(_trumpSuit) << 56);
+	return _cardsKey ^ Random::MakeSeed(HeaderSeed, header);
+}
+
+Card::Suit GameState::GetTrumpSuit() const
+{
+	return _trumpSuit;
+}
+
+const CardSet& GameState::GetHand(PlayerIndex player) const
+{
+	return _hands[player];
+}
+
+const CardSet& GameState::GetAttackCards() const
+{
+	return _attackCards;
+}
+
+const CardSet& GameState::GetDefendCards() const
+{
+	return _defendCards;
+}
+
+CardSet GameState::GetTableCards() const
+{
+	return _attackCards | _defendCards;
+}
+
+CardSet GameState::GetDiscardPile() const
+{
+	CardSet cards = GetTableCards();
+	for (const CardSet& hand : _hands)
+		cards.Add(hand);
+	for (size_t i = _header.deckIndex; i < _deckCount; ++i)
+		cards.Add(CardSet::GetCard(_deck[i]));
+	return ~cards;
+}
+
+size_t GameState::GetDeckCount() const
+{
+	return _deckCount - _header.deckIndex;
+}
+
+std::optional<Card> GameState::GetDeckCard(size_t i) const
+{
+	if (i >= GetDeckCount())
+		return std::nullopt;
+	return CardSet::GetCard(_deck[_header.deckIndex + i]);
+}
+
+void GameState::SetHand(PlayerIndex player, const CardSet& cards)
+{
+	toggleCards(CardSet(_hands[player].GetMask() ^ cards.GetMask()), player);
+	_hands[player] = cards;
+}
+
+void GameState::SetDeckCard(size_t i, const Card& card)
+{
+	uint8_t& deckCard = _deck[_header.deckIndex + i];
+	_cardsKey ^= CardKeys[deckCard][DeckPlace];
+	deckCard = static_cast<uint8_t>(CardSet::GetIndex(card));
+	_cardsKey ^= CardKeys[deckCard][DeckPlace];
+}
+
+CardSet GameState::GetAllowedCards() const
+{
+	switch (_header.phase)
+	{
+	case Phase::Attack:
+		return _attackCards.IsEmpty() ? CardSet::All() : GetTableCards().GetRanks();
+	case Phase::Defend:
+		return CardSet::Beating(CardSet::GetCard(_header.lastAttackCard), _trumpSuit);
+	default:
+		return {};
+	}
+}
+
+CardSet GameState::GetPlayableCards() const
+{
+	if (_header.phase == Phase::Over)
+		return {};
+	return _hands[GetCurrentPlayer()] & GetAllowedCards();
+}
+
+GameState::MoveMask GameState::GetLegalMoves() const
+{
+	MoveMask moves = GetPlayableCards().GetMask();
+
+	// the opening attack can't be skipped
+	const bool openingAttack = _header.phase == Phase::Attack && _attackCards.IsEmpty();
+	if (!openingAttack || !moves)
+		moves |= MoveMask{ 1 } << NoCardMove;
+	return moves;
+}
+
+GameState::Move GameState::GetMove(size_t legalMove) const
+{
+	if (legalMove != NoCardMove)
+		return Move::Play(CardSet::GetCard(legalMove));
+	return _header.phase == Phase::Attack ? Move::Pass() : Move::Take();
+}
+
+GameState::PlayerIndex GameState::next(PlayerIndex player) const
+{
+	// rotate the mask so that the players after this one come first
+	const unsigned mask = _header.playersMask;
+	const unsigned after = mask >> (player + 1);
+	if (after)
+		return static_cast<PlayerIndex>(player + 1 + std::countr_zero(after));
+	return static_cast<PlayerIndex>(std::countr_zero(mask));
+}
+
+GameState::PlayerIndex GameState::getAttackPlayer(size_t turn) const
+{
+	PlayerIndex player = _header.attacker;
+	for (size_t i = 0; i < turn; ++i)
+	{
+		player = next(player);
+		if (player == _header.defender)
+			player = next(player);
+	}
+	return player;
+}
+
+void GameState::startRound(PlayerIndex attacker)
+{
+	_header.attacker = attacker;
+	_header.defender = next(attacker);
+	_header.turn = 0;
+	_header.attacksLimit = static_cast<uint8_t>(std::min(Hand::MinCount, _hands[_header.defender].GetCount()));
+	_header.phase = Phase::Attack;
+}
+
+void GameState::endRound(bool defenderLost)
+{
+	toggleCards(_attackCards, AttackPlace);
+	toggleCards(_defendCards, DefendPlace);
+	_attackCards.Clear();
+	_defendCards.Clear();
+
+	// same order as Round::Run: attackers first, then the defender
+	for (size_t turn = 0; turn + 1 < GetPlayersCount(); ++turn)
+		drawCards(getAttackPlayer(turn));
+	drawCards(_header.defender);
+
+	PlayerIndex nextAttacker = defenderLost ? next(_header.defender) : _header.defender;
+	forEachPlayer(nextAttacker, [this, &nextAttacker](PlayerIndex player)
+		{
+			nextAttacker = player;
+			return !_hands[player].IsEmpty();
+		});
+
+	for (PlayerIndex player = 0; player < MaxPlayersCount; ++player)
+	{
+		if (_hands[player].IsEmpty())
+			_header.playersMask &= ~(1u << player);
+	}
+
+	if (GetPlayersCount() < 2)
+	{
+		_header.phase = Phase::Over;
+		return;
+	}
+
+	startRound(nextAttacker);
+}
+
+void GameState::drawCards(PlayerIndex player)
+{
+	CardSet& hand = _hands[player];
+	while (hand.GetCount() < Hand::MinCount && _header.deckIndex < _deckCount)
+	{
+		const uint8_t card = _deck[_header.deckIndex++];
+		hand.Add(CardSet::GetCard(card));
+		_cardsKey ^= CardKeys[card][DeckPlace] ^ CardKeys[card][player];
+	}
+}
+
+void GameState::toggleCards(const CardSet& cards, size_t place)
+{
+	for (CardSet::Mask mask = cards.GetMask(); mask; mask &= mask - 1)
+		_cardsKey ^= CardKeys[static_cast<size_t>(std::countr_zero(mask))][place];
+}
\ No newline at end of file
@@ -2,39 +2,38 @@
 
 bool Hand::IsEmpty() const
 {
-	return _deque.empty();
+	return _cards.IsEmpty();
 }
 
 size_t Hand::GetCardCount() const
 {
-	return _deque.size();
+	return _cards.GetCount();
 }
 
 Card Hand::GetCard(size_t i) const
 {
-	return _deque.at(i);
+	return _cards.GetNth(i).value();
+}
+
+const CardSet& Hand::GetCards() const
+{
+	return _cards;
 }
 
 Hand& Hand::AddCard(const Card& card)
 {
-	_deque.push_back(card);
+	_cards.Add(card);
 	return *this;
 }
 
-Hand& Hand::RemoveCard(const Card& card)
+Hand& Hand::AddCards(const CardSet& cards)
 {
-	auto iter = std::find(_deque.begin(), _deque.end(), card);
-	if (iter != _deque.end())
-		_deque.erase(iter);
+	_cards.Add(cards);
 	return *this;
 }
 
-bool Hand::ForEachCard(const Callback& callback) const
+Hand& Hand::RemoveCard(const Card& card)
 {
-	for (size_t i = 0; i < GetCardCount(); ++i)
-	{
-		if (callback(_deque[i]))
-			return true;
-	}
-	return false;
+	_cards.Remove(card);
+	return *this;
 }
\ No newline at end of file
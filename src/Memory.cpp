@@ -0,0 +1,121 @@
+#include "Memory.h"
+#include <algorithm>
+
+Memory::Memory(const Player& owner, EventHandlers& events)
+	: AutoEventHandler(events)
+	, _owner(owner)
+{
+}
+
+const CardSet& Memory::GetKnownCards(Player::Id id) const
+{
+	return _knownCards[id];
+}
+
+const CardSet& Memory::GetDiscardPile() const
+{
+	return _discardPile;
+}
+
+const CardSet& Memory::GetTableCards() const
+{
+	return _tableCards;
+}
+
+CardSet Memory::GetUnseenCards() const
+{
+	return ~(_owner.GetHand().GetCards() | _allKnownCards | _discardPile | _tableCards);
+}
+
+CardSet Memory::GetPossibleCards(Player::Id id) const
+{
+	if (id == _owner.GetId())
+		return _owner.GetHand().GetCards();
+	return GetUnseenCards() | _knownCards[id];
+}
+
+CardSet Memory::GetPossibleBeatingCards(Player::Id id, const Card& card, Card::Suit trumpSuit) const
+{
+	return GetPossibleCards(id) & CardSet::Beating(card, trumpSuit);
+}
+
+CardSet Memory::GetImpossibleCards(Player::Id id, Card::Suit trumpSuit) const
+{
+	// keeping trumps back instead of beating is normal play, so they are never ruled out by a take
+	CardSet cards = _lowerTrumps[id];
+	for (const Card card : _notBeatenCards[id])
+		cards.Add(CardSet::Beating(card, trumpSuit) - CardSet::OfSuit(trumpSuit));
+	return cards - _knownCards[id];
+}
+
+void Memory::OnPlayerShowTrumpCard(const Player& player, const Card& card)
+{
+	_knownCards[player.GetId()].Add(card);
+	_allKnownCards.Add(card);
+
+	// the lowest trump in the hand is shown
+	for (const Card lower : CardSet::OfSuit(card.GetSuit()))
+	{
+		if (lower.GetRank() < card.GetRank())
+			_lowerTrumps[player.GetId()].Add(lower);
+	}
+}
+
+void Memory::OnPlayerAttack(const Player& player, const Card& card)
+{
+	onPlayCard(player, card);
+	_openCard = card;
+}
+
+void Memory::OnPlayerDefend(const Player& player, const Card& card)
+{
+	onPlayCard(player, card);
+	_openCard.reset();
+}
+
+void Memory::OnPlayerDrawDeckCards(const Player& player, const CardSet& cards)
+{
+	if (!cards.IsEmpty())
+		forgetImpossibleCards(player.GetId());
+}
+
+void Memory::OnPlayerDrawRoundCards(const Player& player, const CardSet& cards)
+{
+	if (_openCard)
+		_notBeatenCards[player.GetId()].Add(*_openCard);
+
+	_knownCards[player.GetId()].Add(cards);
+	_allKnownCards.Add(cards);
+	_tableCards.Remove(cards);
+}
+
+void Memory::OnRoundEnd(const Round&)
+{
+	// taken cards have already left the table
+	_discardPile.Add(_tableCards);
+	_tableCards.Clear();
+	_openCard.reset();
+}
+
+void Memory::onPlayCard(const Player& player, const Card& card)
+{
+	// cards taken from the table don't count. The trump suit isn't known here,
+	// any other card of the suit of a taken one above it proves the guess wrong
+	const Player::Id id = player.GetId();
+	const bool beatsTakenCard = !_knownCards[id].Contains(card) && std::any_of(_notBeatenCards[id].begin(), _notBeatenCards[id].end(), [&card](const Card& taken)
+		{
+			return taken.GetSuit() == card.GetSuit() && taken.GetRank() < card.GetRank();
+		});
+	if (beatsTakenCard || (_lowerTrumps[id].Contains(card) && !_knownCards[id].Contains(card)))
+		forgetImpossibleCards(id);
+
+	_knownCards[player.GetId()].Remove(card);
+	_allKnownCards.Remove(card);
+	_tableCards.Add(card);
+}
+
+void Memory::forgetImpossibleCards(Player::Id id)
+{
+	_lowerTrumps[id].Clear();
+	_notBeatenCards[id].Clear();
+}
\ No newline at end of file
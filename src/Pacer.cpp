@@ -0,0 +1,46 @@
+#include "Pacer.h"
+#include <algorithm>
+#include "Context.h"
+#include "IController.h"
+#include "Settings.h"
+
+namespace
+{
+	inline Pacer::Duration scale(Pacer::Duration delay, float speed)
+	{
+		if (speed <= 0.f)
+			return {};
+		return std::chrono::duration_cast<Pacer::Duration>(std::chrono::duration<float, Pacer::Duration::period>(delay) / speed);
+	}
+}
+
+void Pacer::Setup(const Settings& settings)
+{
+	_speed = std::max(settings.speed, 0.f);
+	_botDelay = scale(settings.botDelay, _speed);
+	_pauseDelay = scale(settings.pauseDelay, _speed);
+}
+
+void Pacer::Wait(const Context& context, Duration delay) const
+{
+	if (!isPaced(context, delay))
+		return;
+
+	if (auto controller = context.GetController())
+		controller->Wait(context, Clock::now() + delay);
+}
+
+Pacer::Duration Pacer::GetPauseDelay() const
+{
+	return _pauseDelay;
+}
+
+float Pacer::GetSpeed() const
+{
+	return _speed;
+}
+
+bool Pacer::isPaced(const Context& context, Duration delay)
+{
+	return delay.count() > 0 && context.GetController();
+}
\ No newline at end of file
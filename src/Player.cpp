@@ -8,70 +8,53 @@ Player::Player(Id id)
 	: _id(id)
 {}
 
-std::optional<Card> Player::Attack(const Context& context, const Player& defender, const CardFilter& filter)
+std::optional<Card> Player::Attack(Context& context, const Player& defender, const CardSet& allowedCards)
 {
-	const auto attackCard = pickAttackCard(context, defender, filter);
+	const auto attackCard = pickAttackCard(context, defender, _hand.GetCards() & allowedCards);
 	if (attackCard)
 	{
 		removeCard(attackCard);
-		EventHandlers::Get().OnPlayerAttack(*this, *attackCard);
+		context.GetEvents().OnPlayerAttack(*this, *attackCard);
 	}
 	return attackCard;
 }
 
-std::optional<Card> Player::Defend(const Context& context, const Player& attacker, const CardFilter& filter)
+std::optional<Card> Player::Defend(Context& context, const Player& attacker, const CardSet& allowedCards)
 {
-	const auto defendCard = pickDefendCard(context, attacker, filter);
+	const auto defendCard = pickDefendCard(context, attacker, _hand.GetCards() & allowedCards);
 	if (defendCard)
 	{
 		removeCard(defendCard);
-		EventHandlers::Get().OnPlayerDefend(*this, *defendCard);
+		context.GetEvents().OnPlayerDefend(*this, *defendCard);
 	}
 	return defendCard;
 }
 
-Player& Player::DrawCards(Deck& deck)
+Player& Player::DrawCards(Context& context)
 {
-	std::vector<Card> eventCards;
-	if (Hand::MinCount > _hand.GetCardCount())
-		eventCards.reserve(Hand::MinCount - _hand.GetCardCount());
-
+	auto& deck = context.GetDeck();
+	CardSet eventCards;
 	for (size_t i = _hand.GetCardCount(); i < Hand::MinCount && !deck.IsEmpty(); ++i)
 	{
 		const auto card = deck.PopFirst();
 		_hand.AddCard(*card);
-		eventCards.push_back(*card);
+		eventCards.Add(*card);
 	}
 
-	EventHandlers::Get().OnPlayerDrawDeckCards(*this, eventCards);
-	return *this;
-}
-
-Player& Player::DrawCards(const std::vector<Card>& cards)
-{
-	EventHandlers::Get().OnPlayerDrawRoundCards(*this, cards);
-	_hand.AddCards(cards.begin(), cards.end());
+	context.GetEvents().OnPlayerDrawDeckCards(*this, eventCards);
 	return *this;
 }
 
-Player& Player::DrawCards(std::vector<Card>&& cards)
+Player& Player::DrawCards(Context& context, const CardSet& cards)
 {
-	EventHandlers::Get().OnPlayerDrawRoundCards(*this, cards);
-	_hand.AddCards(std::make_move_iterator(cards.begin()), std::make_move_iterator(cards.end()));
+	context.GetEvents().OnPlayerDrawRoundCards(*this, cards);
+	_hand.AddCards(cards);
 	return *this;
 }
 
 std::optional<Card> Player::FindLowestTrumpCard(Card::Suit trumpSuit) const
 {
-	std::optional<Card> lowest;
-	_hand.ForEachCard([&lowest, trumpSuit](const Card& card)
-		{
-			if (card.IsTrump(trumpSuit) && (!lowest || card.GetRank() < lowest->GetRank()))
-				lowest.emplace(card);
-
-			return lowest && lowest->GetRank() == Card::Rank::Min;
-		});
-	return lowest;
+	return _hand.GetCards().GetSuit(trumpSuit).GetLowest();
 }
 
 Player::Id Player::GetId() const
@@ -1,106 +1,69 @@
 #include "PlayersGroup.h"
-#include "Deck.h"
+#include <algorithm>
+#include "Context.h"
+#include "Settings.h"
 #include "User.h"
 #include "Bot.h"
 
-PlayersGroup::PlayersGroup(const Settings& settings)
+PlayersGroup::PlayersGroup(const Settings& settings, EventHandlers& events)
 {
 	Player::Id id = 0;
-	_user = _playerLoop.push_back(PlayerLoop::element::make_holder<User>(id++));
-	for (size_t i = 0; i < settings.botsNumber; ++i)
-		_playerLoop.push_back(PlayerLoop::element::make_holder<Bot>(id++, settings.difficulty));
+	if (settings.withUser)
+	{
+		_seats[id] = std::make_unique<User>(id);
+		_user = _seats[id++].get();
+	}
+
+	const size_t botsNumber = std::min(settings.botsNumber, MaxCount - id);
+	for (size_t i = 0; i < botsNumber; ++i, ++id)
+		_seats[id] = std::make_unique<Bot>(id, settings.GetBotDifficulty(i), settings, events);
+
+	_activeMask = static_cast<Mask>((1u << id) - 1);
 }
 
 PlayersGroup::~PlayersGroup()
 {
 }
 
-void PlayersGroup::DrawCards(Deck& deck, Player* start)
+void PlayersGroup::DrawCards(Context& context, Player* start)
 {
-	ForEach([&deck](Player* player)
+	ForEach([&context](Player* player)
 		{
-			player->DrawCards(deck);
-			return deck.IsEmpty();
+			player->DrawCards(context);
+			return context.GetDeck().IsEmpty();
 		}, start);
 }
 
 Player& PlayersGroup::Next(const Player& player) const
 {
-	return *_playerLoop.next(&player);
-}
-
-Player* PlayersGroup::GetUser() const
-{
-	return _user;
-}
-
-size_t PlayersGroup::GetCount() const
-{
-	return _playerLoop.size();
-}
-
-Player& PlayersGroup::GetDefender(const Player& attacker) const
-{
-	return Next(attacker);
+	const Mask after = static_cast<Mask>(_activeMask & ~((Mask{ 2 } << player.GetId()) - 1));
+	return *_seats[lowestSeat(after ? after : _activeMask)];
 }
 
-void PlayersGroup::RemoveIf(const RemoveIfCallback& removeIf)
+Player& PlayersGroup::Previous(const Player& player) const
 {
-	std::vector<const Player*> playersToRemove;
-	playersToRemove.reserve(GetCount());
-
-	_playerLoop.for_each([&removeIf, &playersToRemove](const Player* player)
-		{
-			if (removeIf(player))
-				playersToRemove.push_back(player);
-			return false;
-		});
-
-	for (const auto* player : playersToRemove)
-		_playerLoop.erase(player);
+	const Mask before = static_cast<Mask>(_activeMask & ((Mask{ 1 } << player.GetId()) - 1));
+	return *_seats[std::bit_width(static_cast<unsigned>(before ? before : _activeMask)) - 1];
 }
 
-bool PlayersGroup::ForEach(const ForEachCallback& callback, const Player* start) const
+Player* PlayersGroup::GetUser() const
 {
-	return _playerLoop.for_each(start ? start : GetUser(), callback);
+	return _user;
 }
 
-bool PlayersGroup::ForEachIdlePlayer(const ForEachCallback& callback, const Player* attacker) const
+Player* PlayersGroup::GetFirst() const
 {
-	if (!attacker)
-		return false;
-
-	bool result = false;
-	_playerLoop.for_each(&Next(GetDefender(*attacker)), [&](Player* player)
-		{
-			result = callback(player);
-			return result || attacker->GetId() == player->GetId();
-		});
-	return result;
+	if (_user && (_activeMask & 1))
+		return _user;
+	return _activeMask ? _seats[lowestSeat(_activeMask)].get() : nullptr;
 }
 
-bool PlayersGroup::ForEachAttackPlayer(const ForEachCallback& callback, const Player* attacker)
+size_t PlayersGroup::GetCount() const
 {
-	return attacker && ForEachOtherPlayer(callback, &GetDefender(*attacker), attacker);
+	return static_cast<size_t>(std::popcount(_activeMask));
 }
 
-bool PlayersGroup::ForEachOtherPlayer(const ForEachCallback& callback, const Player* exclude, const Player* start) const
+Player& PlayersGroup::GetDefender(const Player& attacker) const
 {
-	if (!start)
-		start = GetUser();
-
-	if (exclude)
-	{
-		return _playerLoop.for_each(start, [&](Player* player)
-			{
-				if (exclude->GetId() == player->GetId())
-					return false;
-
-				return callback(player);
-			});
-	}
-	else
-	{
-		return ForEach(callback);
-	}
+	return Next(attacker);
 }
\ No newline at end of file
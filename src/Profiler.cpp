@@ -0,0 +1,122 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include "Drawing.h"
+
+namespace
+{
+	constexpr unsigned int CharacterSize = 12;
+
+	inline double toMilliseconds(Profiler::Clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	struct Stats
+	{
+		double min = 0.;
+		double average = 0.;
+		double p99 = 0.;
+	};
+
+	template<size_t Size>
+	Stats getStats(std::array<Profiler::Clock::duration, Size> times, size_t count)
+	{
+		count = std::min(count, Size);
+		if (count == 0)
+			return {};
+
+		const auto end = times.begin() + count;
+		Profiler::Clock::duration total{};
+		for (auto iter = times.begin(); iter != end; ++iter)
+			total += *iter;
+
+		const auto min = *std::min_element(times.begin(), end);
+		const auto p99 = times.begin() + (count * 99 + 99) / 100 - 1;
+		std::nth_element(times.begin(), p99, end);
+		return { toMilliseconds(min), toMilliseconds(total) / static_cast<double>(count), toMilliseconds(*p99) };
+	}
+}
+
+void Profiler::Toggle()
+{
+	_enabled = !_enabled;
+	_updatesCount = 0;
+	_lastPresent.reset();
+	_framesCount = 0;
+	_sections = {};
+	_lastSections = {};
+	_counters = {};
+}
+
+void Profiler::BeginFrame()
+{
+	if (!_enabled)
+		return;
+
+	_updateStart = Clock::now();
+	_sections = {};
+}
+
+void Profiler::EndFrame(const Counters& counters)
+{
+	if (!_enabled)
+		return;
+
+	_updateTimes[_updatesCount % FramesCount] = Clock::now() - _updateStart;
+	++_updatesCount;
+	_lastSections = _sections;
+	_counters = counters;
+}
+
+void Profiler::Present()
+{
+	if (!_enabled)
+		return;
+
+	const auto now = Clock::now();
+	if (_lastPresent)
+		_frameTimes[_framesCount++ % FramesCount] = now - *_lastPresent;
+	_lastPresent = now;
+}
+
+void Profiler::Pause()
+{
+	_lastPresent.reset();
+}
+
+void Profiler::Draw(sf::RenderTarget& target) const
+{
+	if (!_enabled || _updatesCount == 0)
+		return;
+
+	const Stats frame = getStats(_frameTimes, _framesCount);
+	const Stats update = getStats(_updateTimes, _updatesCount);
+
+	const auto section = [this](Section section)
+		{
+			return toMilliseconds(_lastSections[static_cast<size_t>(section)]);
+		};
+
+	char string[256];
+	std::snprintf(string, sizeof(string),
+		"frame ms: min %.2f avg %.2f p99 %.2f\n"
+		"update ms: min %.2f avg %.2f p99 %.2f\n"
+		"table %.2f deck %.2f players %.2f round %.2f batch %.2f\n"
+		"drawings %zu cards %zu animations %zu events %zu",
+		frame.min, frame.average, frame.p99,
+		update.min, update.average, update.p99,
+		section(Section::Table), section(Section::Deck), section(Section::Players), section(Section::RoundCards), section(Section::Batch),
+		_counters.drawings, _counters.cards, _counters.animations, _counters.queuedEvents);
+
+	Screen::Text text(string, CharacterSize);
+	const auto bounds = text.getLocalBounds();
+	text.setOrigin({ 0.5f * target.getView().getSize().x, bounds.height + CharacterSize });
+	target.draw(text);
+}
+
+void Profiler::add(Section section, Clock::duration duration)
+{
+	_sections[static_cast<size_t>(section)] += duration;
+}
\ No newline at end of file
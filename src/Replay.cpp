@@ -0,0 +1,361 @@
+#include "Replay.h"
+#include <algorithm>
+#include "Context.h"
+
+Replay::Replay(Context& context, const GameLog::Game& game, float speed)
+	: _context(context)
+{
+	const auto& header = game.GetHeader();
+	for (size_t id = header.withUser ? 1 : 0; id < header.difficulties.size(); ++id)
+	{
+		if (header.difficulties[id] < Settings::Difficulty::Count)
+			_settings.botsDifficulties.push_back(header.difficulties[id]);
+	}
+	_settings.botsNumber = header.botsNumber;
+	_settings.withUser = header.withUser;
+	_settings.speed = speed;
+	_settings.seed = header.seed;
+	_context.Setup(_settings);
+
+	auto random = Random::MakeGenerator(header.seed);
+	_deck = Deck(random);
+	_context.GetDeck() = _deck; // the setup has dealt from it, the replay deals the recorded draws again
+
+	_context.GetPlayers().ForEach([this](Player* player)
+		{
+			_players[player->GetId()] = player;
+			++_playersCount;
+			return false;
+		});
+
+	// a game dealt differently than when it was recorded can't be replayed
+	const auto trumpCard = _deck.GetLast();
+	if (trumpCard && CardSet::GetIndex(*trumpCard) == header.trumpCard)
+		game.ForEachEvent([this](const GameLog::Event& event) { return !addAction(event); });
+
+	State state;
+	state.deckCount = static_cast<uint8_t>(_deck.GetCount());
+	_snapshots.reserve(_actions.size() / SnapshotPeriod + 1);
+	for (size_t i = 0; i <= _actions.size(); ++i)
+	{
+		if (i % SnapshotPeriod == 0)
+			_snapshots.push_back(state);
+		if (i < _actions.size())
+			apply(state, _actions[i]);
+	}
+	_state = _snapshots.front();
+}
+
+size_t Replay::GetStepsCount() const
+{
+	return _actions.size();
+}
+
+size_t Replay::GetPosition() const
+{
+	return _position;
+}
+
+bool Replay::Step()
+{
+	if (_position == _actions.size())
+		return false;
+
+	const Action& action = _actions[_position++];
+	play(action);
+	apply(_state, action);
+	return true;
+}
+
+void Replay::Seek(size_t position)
+{
+	position = std::min(position, _actions.size());
+
+	const size_t snapshot = position / SnapshotPeriod;
+	State state = _snapshots[snapshot];
+	for (size_t i = snapshot * SnapshotPeriod; i < position; ++i)
+		apply(state, _actions[i]);
+
+	_state = state;
+	_position = position;
+	show(_state);
+}
+
+void Replay::Run()
+{
+	Seek(_position);
+
+	auto next = Clock::now();
+	for (;;)
+	{
+		while (const auto command = _commands.try_pop())
+		{
+			if (*command == Command::Stop)
+				return;
+			handle(*command, next);
+		}
+
+		const bool playing = !_paused && _position < _actions.size();
+		if (playing && Clock::now() >= next)
+		{
+			next = Clock::now() + getDelay(_actions[_position]);
+			Step();
+			continue;
+		}
+
+		wait(playing ? next : Clock::time_point::max());
+	}
+}
+
+void Replay::Post(Command command)
+{
+	_commands.push(command);
+	{
+		std::lock_guard lock(_wakeMutex);
+		_awake = true;
+	}
+	_wakeCondition.notify_one();
+}
+
+bool Replay::addAction(const GameLog::Event& event)
+{
+	using Type = GameLog::EventType;
+
+	if (event.type >= Type::Count || event.player >= _playersCount)
+		return false;
+	if (event.type == Type::RoundStart ? event.value >= _playersCount : GameLog::HasValue(event.type) && event.value >= CardSet::MaxCount)
+		return false;
+
+	const bool draw = event.type == Type::DrawDeckCard || event.type == Type::DrawRoundCard;
+	if (draw && !_actions.empty() && _actions.back().type == event.type && _actions.back().player == event.player)
+	{
+		_actions.back().cards.Add(event.GetCard());
+		return true;
+	}
+
+	if (event.type == Type::RoundStart)
+		_roundStarts.push_back(_actions.size());
+
+	Action& action = _actions.emplace_back();
+	action.type = event.type;
+	action.player = event.player;
+	action.value = event.value;
+	if (draw)
+		action.cards = CardSet::Of(event.GetCard());
+	return true;
+}
+
+void Replay::apply(State& state, const Action& action)
+{
+	switch (action.type)
+	{
+	case GameLog::EventType::RoundStart:
+		state.attacker = action.player;
+		state.defender = action.value;
+		break;
+
+	case GameLog::EventType::RoundEnd:
+		state.roundCardsCount = 0;
+		break;
+
+	case GameLog::EventType::Attack:
+	case GameLog::EventType::Defend:
+		state.hands[action.player].Remove(CardSet::GetCard(action.value));
+		if (state.roundCardsCount < state.roundCards.size())
+		{
+			state.roundCards[state.roundCardsCount] = action.value;
+			state.roundPlayers[state.roundCardsCount++] = action.player;
+		}
+		break;
+
+	case GameLog::EventType::DrawDeckCard:
+		state.hands[action.player].Add(action.cards);
+		state.deckCount -= static_cast<uint8_t>(std::min<size_t>(state.deckCount, action.cards.GetCount()));
+		break;
+
+	case GameLog::EventType::DrawRoundCard:
+		state.hands[action.player].Add(action.cards);
+		state.roundCardsCount = 0;
+		break;
+
+	case GameLog::EventType::UserWin:
+		state.userWon = true;
+		break;
+
+	case GameLog::EventType::UserLose:
+		state.userLost = true;
+		break;
+
+	case GameLog::EventType::ShowTrumpCard:
+	case GameLog::EventType::Count:
+		break;
+	}
+}
+
+void Replay::play(const Action& action)
+{
+	auto& events = _context.GetEvents();
+	Player& player = *_players[action.player];
+	const auto card = [&action]() { return CardSet::GetCard(action.value); };
+
+	switch (action.type)
+	{
+	case GameLog::EventType::RoundStart:
+		events.OnRoundStart(Round(player, *_players[action.value]));
+		break;
+
+	case GameLog::EventType::RoundEnd:
+		events.OnRoundEnd(Round(player, *_players[_state.defender]));
+		break;
+
+	case GameLog::EventType::Attack:
+		events.OnPlayerAttack(player, card());
+		break;
+
+	case GameLog::EventType::Defend:
+		events.OnPlayerDefend(player, card());
+		break;
+
+	case GameLog::EventType::DrawDeckCard:
+		for (size_t i = 0; i < action.cards.GetCount(); ++i)
+			_context.GetDeck().PopFirst();
+		events.OnPlayerDrawDeckCards(player, action.cards);
+		break;
+
+	case GameLog::EventType::DrawRoundCard:
+		events.OnPlayerDrawRoundCards(player, action.cards);
+		break;
+
+	case GameLog::EventType::ShowTrumpCard:
+		events.OnPlayerShowTrumpCard(player, card());
+		break;
+
+	case GameLog::EventType::UserWin:
+		events.OnUserWin(player);
+		break;
+
+	case GameLog::EventType::UserLose:
+		events.OnUserLose(player);
+		break;
+
+	case GameLog::EventType::Count:
+		break;
+	}
+}
+
+// deals the hands of the state from the deck instantly and plays the round cards on top of them
+void Replay::show(const State& state)
+{
+	const float speed = _settings.speed;
+	setSpeed(0.f);
+
+	auto& events = _context.GetEvents();
+	auto& deck = _context.GetDeck();
+	deck = _deck;
+	while (deck.GetCount() > state.deckCount)
+		deck.PopFirst();
+
+	events.OnStartGame();
+	events.OnPlayersCreated(_context.GetPlayers());
+
+	for (Player::Id id = 0; id < _playersCount; ++id)
+	{
+		CardSet cards = state.hands[id];
+		for (size_t i = 0; i < state.roundCardsCount; ++i)
+		{
+			if (state.roundPlayers[i] == id)
+				cards.Add(CardSet::GetCard(state.roundCards[i]));
+		}
+
+		if (!cards.IsEmpty())
+			events.OnPlayerDrawDeckCards(*_players[id], cards);
+	}
+
+	for (size_t i = 0; i < state.roundCardsCount; ++i)
+	{
+		const Player& player = *_players[state.roundPlayers[i]];
+		const Card card = CardSet::GetCard(state.roundCards[i]);
+		if (i % 2 == 0)
+			events.OnPlayerAttack(player, card);
+		else
+			events.OnPlayerDefend(player, card);
+	}
+
+	if (const Player* user = _context.GetPlayers().GetUser())
+	{
+		if (state.userWon)
+			events.OnUserWin(*user);
+		else if (state.userLost)
+			events.OnUserLose(*user);
+	}
+
+	setSpeed(speed);
+}
+
+void Replay::setSpeed(float speed)
+{
+	_settings.speed = speed;
+	_context.GetPacer().Setup(_settings);
+}
+
+// the step stays on the screen a pause long, the ones the controller pauses on twice as long
+Replay::Clock::duration Replay::getDelay(const Action& action) const
+{
+	const auto delay = _context.GetPacer().GetPauseDelay();
+	const bool paused = action.type == GameLog::EventType::RoundStart || action.type == GameLog::EventType::ShowTrumpCard;
+	return paused ? 2 * delay : delay;
+}
+
+void Replay::handle(Command command, Clock::time_point& next)
+{
+	switch (command)
+	{
+	case Command::Pause:
+		_paused = !_paused;
+		next = Clock::now();
+		break;
+
+	case Command::Step:
+		_paused = true;
+		Step();
+		break;
+
+	case Command::Back:
+	{
+		// the round that has just started is skipped
+		const auto round = std::lower_bound(_roundStarts.begin(), _roundStarts.end(), _position ? _position - 1 : 0);
+		Seek(round == _roundStarts.begin() ? 0 : *std::prev(round));
+		next = Clock::now() + _context.GetPacer().GetPauseDelay();
+		break;
+	}
+
+	case Command::Forward:
+	{
+		const auto round = std::upper_bound(_roundStarts.begin(), _roundStarts.end(), _position);
+		Seek(round == _roundStarts.end() ? _actions.size() : *round);
+		next = Clock::now() + _context.GetPacer().GetPauseDelay();
+		break;
+	}
+
+	case Command::Faster:
+		setSpeed(std::min(_settings.speed * 2.f, MaxSpeed));
+		break;
+
+	case Command::Slower:
+		setSpeed(std::max(_settings.speed / 2.f, MinSpeed));
+		break;
+
+	case Command::Stop:
+		break;
+	}
+}
+
+void Replay::wait(Clock::time_point until)
+{
+	std::unique_lock lock(_wakeMutex);
+	if (until == Clock::time_point::max())
+		_wakeCondition.wait(lock, [this]() { return _awake; });
+	else
+		_wakeCondition.wait_until(lock, until, [this]() { return _awake; });
+	_awake = false;
+}
\ No newline at end of file
@@ -1,8 +1,8 @@
 #include "Round.h"
 #include <map>
+#include <cassert>
 #include "Context.h"
 #include "Player.h"
-#include "UI.h"
 #include "Event.hpp"
 #include "PlayersGroup.h"
 
@@ -28,38 +28,35 @@ Round::Round(Player& attacker, Player& defender)
 std::unique_ptr<Round> Round::Run(Context& context)
 {
 	_cards = {};
+	auto& state = context.GetState();
 	auto& players = context.GetPlayers();
-	EventHandlers::Get().OnRoundStart(*this);
+	context.GetEvents().OnRoundStart(*this);
 
 	bool defenderLost = false;
-	_cards.reserve(MaxAttacksCount * 2);
 	const size_t attackCount = std::min(MaxAttacksCount, _defender.GetHand().GetCardCount());
 	for (size_t attackIndex = 0; attackIndex < attackCount; ++attackIndex)
 	{
+		const CardSet attackCards = state.GetAllowedCards();
 		std::optional<Card> attackCard;
 		players.ForEachAttackPlayer([&](Player* attackPlayer)
 			{
-				attackCard = attackPlayer->Attack(context, _defender, [&](const Card& card) -> bool
-					{
-						return _cards.empty()
-							|| std::find_if(_cards.cbegin(), _cards.cend(), [&card](const Card& roundCard) { return roundCard.GetRank() == card.GetRank(); }) != _cards.cend();
-					});
+				attackCard = attackPlayer->Attack(context, _defender, attackCards);
+				state.ApplyMove(attackCard ? GameState::Move::Play(*attackCard) : GameState::Move::Pass());
 				return attackCard.has_value();
 			}, &_attacker);
 
 		if (attackCard)
 		{
-			_cards.push_back(*attackCard);
-			if (const auto defendCard = _defender.Defend(context, _attacker, [&](const Card& card) -> bool
-				{
-					return card.Beats(*attackCard, context.GetTrumpSuit());
-				}))
+			_cards.Add(*attackCard);
+			if (const auto defendCard = _defender.Defend(context, _attacker, state.GetAllowedCards()))
 			{
-				_cards.push_back(*defendCard);
+				state.ApplyMove(GameState::Move::Play(*defendCard));
+				_cards.Add(*defendCard);
 			}
 			else
 			{
-				_defender.DrawCards(_cards);
+				state.ApplyMove(GameState::Move::Take());
+				_defender.DrawCards(context, _cards);
 				defenderLost = true;
 				break;
 			}
@@ -70,33 +67,46 @@ std::unique_ptr<Round> Round::Run(Context& context)
 		}
 	}
 
-	EventHandlers::Get().OnRoundEnd(*this);
+	context.GetEvents().OnRoundEnd(*this);
 
 	const auto drawCards = [&](Player* player)
 		{
-			player->DrawCards(context.GetDeck());
+			player->DrawCards(context);
 			return context.GetDeck().IsEmpty();
 		};
 
 	players.ForEachAttackPlayer(drawCards, &_attacker);
 	drawCards(&_defender);
 
-	const auto* user = players.GetUser();
-	if (hasNoCards(user))
+	if (const auto* user = players.GetUser())
 	{
-		EventHandlers::Get().OnUserWin(*user);
-		return nullptr;
-	}
+		if (hasNoCards(user))
+		{
+			context.GetEvents().OnUserWin(*user);
+			return nullptr;
+		}
 
-	if (context.GetDeck().IsEmpty() && players.ForEachOtherPlayer(hasNoCards, user))
-	{
-		EventHandlers::Get().OnUserLose(*players.GetUser());
-		return nullptr;
+		if (context.GetDeck().IsEmpty() && players.ForEachOtherPlayer(hasNoCards, user))
+		{
+			context.GetEvents().OnUserLose(*user);
+			return nullptr;
+		}
 	}
+
+	Player* nextAttacker = defenderLost ? &players.Next(_defender) : &_defender;
+	players.ForEach([&nextAttacker](Player* player)
+		{
+			nextAttacker = player;
+			return hasAnyCards(player);
+		}, nextAttacker);
+
 	players.RemoveIf(hasNoCards);
+	if (players.GetCount() < 2)
+		return nullptr;
+
+	assert(state.GetAttacker() == nextAttacker->GetId() && state.GetPlayersCount() == players.GetCount());
 
-	auto& nextAttacker = defenderLost ? players.Next(_defender) : _defender;
-	return std::make_unique<Round>(nextAttacker, players.GetDefender(nextAttacker));
+	return std::make_unique<Round>(*nextAttacker, players.GetDefender(*nextAttacker));
 }
 
 const Round::Cards& Round::GetCards() const
@@ -0,0 +1,167 @@
+#include "Sampler.h"
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+	using Cards = std::array<uint8_t, CardSet::MaxCount>;
+
+	inline size_t getIndices(CardSet::Mask mask, Cards& cards)
+	{
+		size_t count = 0;
+		for (; mask; mask &= mask - 1)
+			cards[count++] = static_cast<uint8_t>(std::countr_zero(mask));
+		return count;
+	}
+
+	// uniform pick of count cards from the mask
+	inline CardSet::Mask pick(CardSet::Mask mask, size_t count, Random::Generator& random)
+	{
+		Cards cards;
+		const size_t cardsCount = getIndices(mask, cards);
+		if (count >= cardsCount)
+			return mask;
+
+		CardSet::Mask picked = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::swap(cards[i], cards[Random::GetNumber(random, cardsCount - 1, i)]);
+			picked |= CardSet::Mask{ 1 } << cards[i];
+		}
+		return picked;
+	}
+}
+
+Sampler::Sampler(const GameState& state, const Beliefs& beliefs)
+{
+	const GameState::PlayerIndex self = state.GetCurrentPlayer();
+
+	_hiddenCards = ~(state.GetHand(self) | state.GetTableCards() | state.GetDiscardPile());
+	const size_t deckCount = state.GetDeckCount();
+	if (deckCount > 0)
+	{
+		_hiddenCards.Remove(*state.GetDeckCard(deckCount - 1)); // trump card lies face up
+		_deckCount = deckCount - 1;
+	}
+
+	const CardSet unknownCards = _hiddenCards;
+	for (GameState::PlayerIndex player = 0; player < GameState::MaxPlayersCount; ++player)
+	{
+		if (player == self || !state.IsInGame(player))
+			continue;
+
+		Hand& hand = _hands[_handsCount++];
+		hand.player = player;
+
+		const size_t handCount = state.GetHand(player).GetCount();
+		for (const Card card : beliefs[player].knownCards & unknownCards)
+		{
+			if (hand.knownCards.GetCount() == handCount)
+				break;
+			hand.knownCards.Add(card);
+		}
+		hand.count = handCount - hand.knownCards.GetCount();
+		_hiddenCards.Remove(hand.knownCards);
+	}
+
+	for (size_t i = 0; i < _handsCount; ++i)
+		_hands[i].allowedCards = _hiddenCards - beliefs[_hands[i].player].impossibleCards;
+
+	// the hands with the fewest spare cards go first, they have the least choice
+	std::sort(_hands.begin(), _hands.begin() + _handsCount, [](const Hand& a, const Hand& b)
+		{
+			return a.allowedCards.GetCount() - std::min(a.count, a.allowedCards.GetCount())
+				< b.allowedCards.GetCount() - std::min(b.count, b.allowedCards.GetCount());
+		});
+
+	setGroups();
+
+	// no deal fits the beliefs, so they are wrong somewhere and only the known cards are kept
+	const bool possible = std::all_of(_groupCards.begin(), _groupCards.begin() + (size_t{ 1 } << _handsCount), [this, group = size_t{ 0 }](CardSet::Mask cards) mutable
+		{
+			return static_cast<size_t>(std::popcount(cards)) >= _groupCounts[group++];
+		});
+
+	if (!possible)
+	{
+		for (size_t i = 0; i < _handsCount; ++i)
+			_hands[i].allowedCards = _hiddenCards;
+		setGroups();
+	}
+}
+
+// Hall's condition: a deal exists while every group of hands has at least as many allowed cards left
+// as it needs. Only the groups of the hands after the current one can run short, their needs don't
+// change until their turn. A card is given only if no such group without spare cards needs it
+void Sampler::Deal(GameState& state, Random::Generator& random) const
+{
+	CardSet::Mask cards = _hiddenCards.GetMask();
+	const size_t allHands = (size_t{ 1 } << _handsCount) - 1;
+
+	for (size_t i = 0; i < _handsCount; ++i)
+	{
+		const Hand& hand = _hands[i];
+		const size_t laterHands = allHands & ~((size_t{ 2 } << i) - 1);
+
+		size_t spareCount = CardSet::MaxCount;
+		for (size_t group = laterHands; group; group = (group - 1) & laterHands)
+		{
+			const size_t count = static_cast<size_t>(std::popcount(_groupCards[group] & cards));
+			spareCount = std::min(spareCount, count - std::min<size_t>(count, _groupCounts[group]));
+		}
+
+		// the hand can't take so many cards from the later ones that they run short, no checks needed
+		const CardSet::Mask picked = spareCount >= hand.count
+			? pick(hand.allowedCards.GetMask() & cards, hand.count, random)
+			: pickChecked(hand, laterHands, cards, random);
+
+		cards &= ~picked;
+		state.SetHand(hand.player, CardSet(hand.knownCards.GetMask() | picked));
+	}
+
+	Cards deck;
+	const size_t deckCount = std::min(getIndices(cards, deck), _deckCount);
+	Random::Shuffle(random, deck.begin(), deck.begin() + deckCount);
+	for (size_t i = 0; i < deckCount; ++i)
+		state.SetDeckCard(i, CardSet::GetCard(deck[i]));
+}
+
+CardSet::Mask Sampler::pickChecked(const Hand& hand, size_t laterHands, CardSet::Mask cards, Random::Generator& random) const
+{
+	CardSet::Mask picked = 0;
+	for (size_t n = 0; n < hand.count; ++n)
+	{
+		CardSet::Mask blocked = 0;
+		for (size_t group = laterHands; group; group = (group - 1) & laterHands)
+		{
+			if (static_cast<size_t>(std::popcount(_groupCards[group] & cards)) <= _groupCounts[group])
+				blocked |= _groupCards[group];
+		}
+
+		const CardSet candidates(hand.allowedCards.GetMask() & cards & ~blocked);
+		if (candidates.IsEmpty())
+			break; // the state doesn't add up, e.g. more cards in hands than hidden
+
+		const CardSet::Mask card = CardSet::Of(*candidates.GetNth(Random::GetNumber(random, candidates.GetCount() - 1))).GetMask();
+		picked |= card;
+		cards &= ~card;
+	}
+	return picked;
+}
+
+void Sampler::setGroups()
+{
+	for (size_t group = 0; group < (size_t{ 1 } << _handsCount); ++group)
+	{
+		_groupCards[group] = 0;
+		_groupCounts[group] = 0;
+		for (size_t i = 0; i < _handsCount; ++i)
+		{
+			if ((group >> i) & 1)
+			{
+				_groupCards[group] |= _hands[i].allowedCards.GetMask();
+				_groupCounts[group] += static_cast<uint8_t>(_hands[i].count);
+			}
+		}
+	}
+}
\ No newline at end of file
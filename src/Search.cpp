@@ -0,0 +1,242 @@
+#include "Search.h"
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	using MoveMask = GameState::MoveMask;
+	using Visits = std::array<uint64_t, CardSet::MaxCount + 1>;
+	using Rewards = std::array<double, GameState::MaxPlayersCount>;
+
+	constexpr size_t NoCardMove = GameState::NoCardMove;
+	constexpr uint32_t NoNode = std::numeric_limits<uint32_t>::max();
+	constexpr double Exploration = 0.7;
+	constexpr size_t MaxPlayoutMovesCount = 400; // bots can repeat the same takes forever
+	constexpr size_t DeadlineCheckPeriod = 16;
+
+	inline size_t getNthBit(MoveMask mask, size_t n)
+	{
+		for (; n > 0; --n)
+			mask &= mask - 1;
+		return static_cast<size_t>(std::countr_zero(mask));
+	}
+
+	inline Rewards getRewards(const GameState& state)
+	{
+		Rewards rewards;
+		rewards.fill(state.GetPhase() == GameState::Phase::Over ? 1. : 0.5);
+
+		if (state.GetPhase() == GameState::Phase::Over)
+		{
+			for (GameState::PlayerIndex player = 0; player < GameState::MaxPlayersCount; ++player)
+			{
+				if (state.IsInGame(player))
+					rewards[player] = 0.; // durak
+			}
+		}
+		return rewards;
+	}
+
+	class Tree final
+	{
+	public:
+		Tree(const GameState& root, const Search::Beliefs& beliefs, Random::Seed seed)
+			: _root(root)
+			, _sampler(root, beliefs)
+			, _random(Random::MakeGenerator(seed))
+		{
+			_nodes.emplace_back();
+		}
+
+		void Run(size_t iterations, Clock::time_point deadline)
+		{
+			for (size_t i = 0; iterations == 0 || i < iterations; ++i)
+			{
+				if (i % DeadlineCheckPeriod == 0 && Clock::now() >= deadline)
+					break;
+				iterate();
+			}
+		}
+
+		void AddRootVisits(Visits& visits) const
+		{
+			for (uint32_t child = _nodes.front().firstChild; child != NoNode; child = _nodes[child].nextSibling)
+				visits[_nodes[child].move] += _nodes[child].visits;
+		}
+
+	private:
+		struct Node
+		{
+			uint32_t parent = NoNode;
+			uint32_t firstChild = NoNode;
+			uint32_t nextSibling = NoNode;
+			uint32_t visits = 0;
+			uint32_t availability = 0;
+			double reward = 0.;
+			uint8_t move = NoCardMove;
+			GameState::PlayerIndex player = 0; // who made the move
+		};
+
+		void iterate()
+		{
+			GameState state = sample();
+			uint32_t node = 0;
+
+			while (state.GetPhase() != GameState::Phase::Over)
+			{
+				const MoveMask legalMoves = state.GetLegalMoves();
+				MoveMask untriedMoves = legalMoves;
+				uint32_t bestChild = NoNode;
+				double bestScore = 0.;
+
+				for (uint32_t child = _nodes[node].firstChild; child != NoNode; child = _nodes[child].nextSibling)
+				{
+					Node& childNode = _nodes[child];
+					const MoveMask move = MoveMask{ 1 } << childNode.move;
+					if (!(legalMoves & move))
+						continue;
+
+					untriedMoves &= ~move;
+					++childNode.availability;
+
+					const double score = childNode.reward / childNode.visits
+						+ Exploration * std::sqrt(std::log(static_cast<double>(childNode.availability)) / childNode.visits);
+					if (bestChild == NoNode || score > bestScore)
+					{
+						bestChild = child;
+						bestScore = score;
+					}
+				}
+
+				if (untriedMoves)
+				{
+					const size_t index = Random::GetNumber(_random, static_cast<size_t>(std::popcount(untriedMoves)) - 1);
+					const size_t move = getNthBit(untriedMoves, index);
+					node = addNode(node, move, state.GetCurrentPlayer());
+					state.ApplyMove(state.GetMove(move));
+					break;
+				}
+
+				node = bestChild;
+				state.ApplyMove(state.GetMove(_nodes[node].move));
+			}
+
+			const Rewards rewards = playout(state);
+			for (; node != NoNode; node = _nodes[node].parent)
+			{
+				++_nodes[node].visits;
+				_nodes[node].reward += rewards[_nodes[node].player];
+			}
+		}
+
+		uint32_t addNode(uint32_t parent, size_t move, GameState::PlayerIndex player)
+		{
+			const uint32_t index = static_cast<uint32_t>(_nodes.size());
+			Node& node = _nodes.emplace_back();
+			node.parent = parent;
+			node.nextSibling = _nodes[parent].firstChild;
+			node.availability = 1;
+			node.move = static_cast<uint8_t>(move);
+			node.player = player;
+			_nodes[parent].firstChild = index;
+			return index;
+		}
+
+		// one deal of the cards the current player can't see that fits the beliefs
+		GameState sample()
+		{
+			GameState state = _root;
+			_sampler.Deal(state, _random);
+			return state;
+		}
+
+		Rewards playout(GameState& state)
+		{
+			for (size_t i = 0; i < MaxPlayoutMovesCount && state.GetPhase() != GameState::Phase::Over; ++i)
+				state.ApplyMove(getPlayoutMove(state));
+			return getRewards(state);
+		}
+
+		// cheap policy close to the medium bot, with some noise to explore
+		GameState::Move getPlayoutMove(const GameState& state)
+		{
+			if (Random::GetNumber(_random, 7) == 0)
+			{
+				const MoveMask legalMoves = state.GetLegalMoves();
+				const size_t index = Random::GetNumber(_random, static_cast<size_t>(std::popcount(legalMoves)) - 1);
+				return state.GetMove(getNthBit(legalMoves, index));
+			}
+
+			const CardSet playableCards = state.GetPlayableCards();
+			const CardSet notTrumps = playableCards - CardSet::OfSuit(state.GetTrumpSuit());
+			const auto card = notTrumps.IsEmpty() ? playableCards.GetLowest() : notTrumps.GetLowest();
+
+			if (state.GetPhase() == GameState::Phase::Attack)
+			{
+				const bool openingAttack = state.GetAttackCards().IsEmpty();
+				if (!card || (!openingAttack && notTrumps.IsEmpty()))
+					return GameState::Move::Pass();
+				return GameState::Move::Play(*card);
+			}
+
+			return card ? GameState::Move::Play(*card) : GameState::Move::Take();
+		}
+
+	private:
+		const GameState& _root;
+		const Sampler _sampler;
+		Random::Generator _random;
+		std::vector<Node> _nodes;
+	};
+}
+
+GameState::Move Search::FindMove(const GameState& state, const Beliefs& beliefs, const Options& options, Random::Seed seed)
+{
+	const MoveMask legalMoves = state.GetLegalMoves();
+	if (std::popcount(legalMoves) == 1)
+		return state.GetMove(static_cast<size_t>(std::countr_zero(legalMoves)));
+
+	const size_t threadsCount = std::max<size_t>(options.threadsCount ? options.threadsCount : std::thread::hardware_concurrency(), 1);
+	const size_t iterations = options.iterations || options.time.count() > 0 ? options.iterations : 1;
+	const auto deadline = options.time.count() > 0 ? Clock::now() + options.time : Clock::time_point::max();
+
+	// root parallelization: independent trees, their root visits are summed up
+	std::vector<Visits> visits(threadsCount, Visits{});
+	const auto search = [&](size_t i)
+		{
+			Tree tree(state, beliefs, Random::MakeSeed(seed, i));
+			tree.Run(iterations, deadline);
+			tree.AddRootVisits(visits[i]);
+		};
+
+	std::vector<std::thread> workers;
+	workers.reserve(threadsCount - 1);
+	for (size_t i = 1; i < threadsCount; ++i)
+		workers.emplace_back(search, i);
+	search(0);
+
+	for (auto& worker : workers)
+		worker.join();
+
+	size_t bestMove = static_cast<size_t>(std::countr_zero(legalMoves));
+	uint64_t bestVisits = 0;
+	for (MoveMask moves = legalMoves; moves; moves &= moves - 1)
+	{
+		const size_t move = static_cast<size_t>(std::countr_zero(moves));
+		uint64_t moveVisits = 0;
+		for (const Visits& threadVisits : visits)
+			moveVisits += threadVisits[move];
+
+		if (moveVisits > bestVisits)
+		{
+			bestMove = move;
+			bestVisits = moveVisits;
+		}
+	}
+	return state.GetMove(bestMove);
+}
\ No newline at end of file
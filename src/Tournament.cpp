@@ -0,0 +1,106 @@
+#include "Tournament.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "Context.h"
+#include "Engine.h"
+#include "GameLog.h"
+
+namespace
+{
+	constexpr size_t BatchesPerThread = 8; // the last batches are small, so the threads finish about together
+
+	// Each worker owns everything a game touches: the context with its event bus, the players and their memories.
+	// Every game gets its own random stream derived from the tournament seed.
+	inline Tournament::Result runWorker(const Tournament::Options& options, Random::Seed seed, size_t batchSize, std::atomic<size_t>& nextGame)
+	{
+		Settings settings = options.settings;
+		Tournament::Result result;
+		result.durakCount.resize(options.settings.botsNumber + (options.settings.withUser ? 1 : 0), 0);
+
+		std::optional<GameLog::Batch> batch;
+		if (options.log)
+			batch.emplace(*options.log);
+
+		for (size_t first = nextGame.fetch_add(batchSize, std::memory_order_relaxed); first < options.gamesCount; first = nextGame.fetch_add(batchSize, std::memory_order_relaxed))
+		{
+			const size_t last = std::min(first + batchSize, options.gamesCount);
+			for (size_t i = first; i < last; ++i)
+			{
+				settings.seed = Random::MakeSeed(seed, i);
+
+				Context context;
+				std::optional<GameLog::Recorder> recorder;
+				if (batch)
+					recorder.emplace(*batch, context, settings);
+				context.Setup(settings);
+
+				const auto gameResult = Engine::Run(context, options.maxRoundsCount);
+				++result.gamesCount;
+				result.roundsCount += gameResult.roundsCount;
+				if (gameResult.interrupted)
+					++result.interruptedCount;
+				else if (gameResult.durak)
+					++result.durakCount[*gameResult.durak];
+				else
+					++result.drawsCount;
+			}
+		}
+		return result;
+	}
+}
+
+Tournament::Result& Tournament::Result::Merge(const Result& other)
+{
+	gamesCount += other.gamesCount;
+	roundsCount += other.roundsCount;
+	drawsCount += other.drawsCount;
+	interruptedCount += other.interruptedCount;
+
+	if (durakCount.size() < other.durakCount.size())
+		durakCount.resize(other.durakCount.size(), 0);
+	for (size_t i = 0; i < other.durakCount.size(); ++i)
+		durakCount[i] += other.durakCount[i];
+
+	return *this;
+}
+
+double Tournament::Result::GetGamesPerSecond() const
+{
+	return seconds > 0. ? static_cast<double>(gamesCount) / seconds : 0.;
+}
+
+Tournament::Result Tournament::Run(const Options& options)
+{
+	size_t threadsCount = options.threadsCount ? options.threadsCount : std::thread::hardware_concurrency();
+	threadsCount = std::clamp<size_t>(threadsCount, 1, std::max<size_t>(1, options.gamesCount));
+	const size_t batchSize = std::max<size_t>(1, options.gamesCount / (threadsCount * BatchesPerThread));
+
+	const Random::Seed seed = options.seed ? *options.seed : Random::MakeSeed();
+	std::atomic<size_t> nextGame = 0;
+	std::vector<Result> results(threadsCount);
+	std::vector<std::thread> workers;
+	workers.reserve(threadsCount);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < threadsCount; ++i)
+	{
+		workers.emplace_back([&options, seed, batchSize, &nextGame, &result = results[i]]()
+			{
+				result = runWorker(options, seed, batchSize, nextGame);
+			});
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	Result result;
+	for (const auto& workerResult : results)
+		result.Merge(workerResult);
+
+	result.threadsCount = threadsCount;
+	result.seconds = elapsed.count();
+	return result;
+}
\ No newline at end of file
@@ -1,5 +1,4 @@
 #include "UI.h"
-#include <mutex>
 #include <queue>
 #include <thread>
 #include <SFML/Graphics/RenderWindow.hpp>
@@ -17,14 +16,12 @@
 namespace
 {
 	constexpr float InteractOffset = 5.f;
-
-	std::mutex g_mutex;
-	
-	[[nodiscard]]
-	inline std::lock_guard<std::mutex> lockMutex()
-	{
-		return std::lock_guard<std::mutex>(g_mutex);
-	}
+	constexpr float ShowCardOffset = 200.f;
+	constexpr float ShowCardDurationCoeff = 0.5f;
+	constexpr float InstantAnimationSeconds = 1.e6f; // longer than any animation
+	constexpr auto IdleRedrawPeriod = std::chrono::seconds(1);
+	constexpr auto UnfocusedFramePeriod = std::chrono::milliseconds(100);
+	constexpr auto ProfilerKey = sf::Keyboard::F3;
 
 	inline sf::Vector2f getCardSize()
 	{
@@ -65,26 +62,49 @@ namespace
 
 	struct State
 	{
-		static constexpr float tolerance = 1.e-2f;
-
 		sf::Vector2f position;
 		float angleDegree = 0.f;
 
-		bool operator==(const State& other) const
+		static State Interpolate(const State& from, const State& to, float progress)
 		{
-			return std::abs(position.x - other.position.x) < tolerance
-				&& std::abs(position.y - other.position.y) < tolerance
-				&& std::abs(angleDegree - other.angleDegree) < tolerance;
+			return { from.position + (to.position - from.position) * progress, from.angleDegree + (to.angleDegree - from.angleDegree) * progress };
 		}
 	};
 
+	enum class Easing
+	{
+		Linear,
+		In, // cubic
+		Out,
+		InOut,
+	};
+
+	inline float ease(Easing easing, float t)
+	{
+		switch (easing)
+		{
+		case Easing::Linear:	return t;
+		case Easing::In:		return t * t * t;
+		case Easing::Out:		return 1.f - (1.f - t) * (1.f - t) * (1.f - t);
+		case Easing::InOut:		return t < 0.5f ? 4.f * t * t * t : 1.f - 4.f * (1.f - t) * (1.f - t) * (1.f - t);
+		}
+		return t;
+	}
+
+	// animation time passes faster with the speed, 0 - instant
+	inline sf::Time getAnimationDelta(sf::Time delta, float speed)
+	{
+		return speed > 0.f ? delta * speed : sf::seconds(InstantAnimationSeconds);
+	}
+
 	struct Animation
 	{
 		using OnStart = std::function<void()>;
 		using OnFinish = std::function<void()>;
 
 		State finalState;
-		float deltaPerFrame = 15.f;
+		sf::Time duration = sf::seconds(0.5f);
+		Easing easing = Easing::Out;
 		OnStart onStart;
 		OnFinish onFinish;
 	};
@@ -102,49 +122,39 @@ namespace
 			_open = open;
 		}
 
-		bool Draw(sf::Time delta, sf::RenderTarget& target)
+		bool Draw(sf::Time delta, Screen::CardBatch& batch)
 		{
-			std::unique_ptr<Screen::Card> screenCard;
-			if (_open)
-				screenCard = std::make_unique<Screen::OpenCard>(_cardInfo);
-			else
-				screenCard = std::make_unique<Screen::CloseCard>();
-
-			const bool hasAnimations = HasAnimations();
-			if (HasAnimations())
+			while (HasAnimations())
 			{
 				auto& animation = _animations.front();
-				if (animation.onStart)
-				{
-					animation.onStart();
-					animation.onStart = {};
-				}
-
-				if (_state == animation.finalState)
+				if (!_started)
 				{
-					_state = animation.finalState;
-					if (animation.onFinish)
-						animation.onFinish();
-					_animations.pop();
+					_started = true;
+					_startState = _state;
+					_elapsed = sf::Time::Zero;
+					if (animation.onStart)
+						animation.onStart();
 				}
-				else
-				{
-					sf::Vector2f dir = animation.finalState.position - _state.position;
-					dir /= animation.deltaPerFrame;
-
-					float angleDelta = animation.finalState.angleDegree - _state.angleDegree;
-					angleDelta /= animation.deltaPerFrame;
 
-					_state.position += dir;
-					_state.angleDegree += angleDelta;
-				}
+				_elapsed += delta;
+				const float progress = animation.duration > sf::Time::Zero ? std::min(_elapsed / animation.duration, 1.f) : 1.f;
+				_state = State::Interpolate(_startState, animation.finalState, ease(animation.easing, progress));
+				if (progress < 1.f)
+					break;
+
+				// the time left goes to the next animation
+				delta = _elapsed - animation.duration;
+				_state = animation.finalState;
+				_started = false;
+
+				const auto onFinish = std::move(animation.onFinish);
+				_animations.pop();
+				if (onFinish)
+					onFinish();
 			}
 
-			screenCard->setOrigin(_state.position);
-			screenCard->setRotation(_state.angleDegree);
-			target.draw(*screenCard);
-
-			return !hasAnimations;
+			batch.Add(_open ? std::optional(_cardInfo) : std::nullopt, _state.position, _state.angleDegree);
+			return !HasAnimations();
 		}
 
 		void StartAnimation(const Animation& animation)
@@ -155,6 +165,7 @@ namespace
 		void ResetAnimation()
 		{
 			_animations = {};
+			_started = false;
 		}
 
 		const State& GetState() const
@@ -187,6 +198,9 @@ namespace
 		::Card _cardInfo;
 		State _state;
 		std::queue<Animation> _animations;
+		State _startState; // of the first animation
+		sf::Time _elapsed;
+		bool _started = false;
 		bool _open = false;
 	};
 
@@ -234,12 +248,12 @@ namespace
 			_cards.at(cardInfo).StartAnimation(animation);
 		}
 
-		virtual bool Draw(sf::Time delta, sf::RenderTarget& target)
+		virtual bool Draw(sf::Time delta, Screen::CardBatch& batch)
 		{
 			bool res = true;
-			_cards.for_each([&res, delta, &target](VisibleCard& visibleCard)
+			_cards.for_each([&res, delta, &batch](VisibleCard& visibleCard)
 				{
-					res = visibleCard.Draw(delta, target) && res;
+					res = visibleCard.Draw(delta, batch) && res;
 					return false;
 				});
 			return res;
@@ -250,12 +264,23 @@ namespace
 			return _cards.size();
 		}
 
+		size_t GetAnimationsCount() const
+		{
+			size_t count = 0;
+			_cards.for_each([&count](const VisibleCard& visibleCard)
+				{
+					count += visibleCard.HasAnimations();
+					return false;
+				});
+			return count;
+		}
+
 		std::optional<State> GetState(const ::Card& cardInfo) const
 		{
 			return _cards.at(cardInfo).GetState();
 		}
 
-		virtual std::optional<Card> Pick(const sf::Vector2f& cursor, float interactOffset = 0.f, const std::function<bool(const Card&)>& filter = {}) const
+		virtual std::optional<Card> Pick(const sf::Vector2f& cursor, float interactOffset = 0.f, const CardSet& playableCards = CardSet::All()) const
 		{
 			return std::nullopt;
 		}
@@ -285,9 +310,9 @@ namespace
 	public:
 		using VisibleCards::VisibleCards;
 
-		bool Draw(sf::Time delta, sf::RenderTarget& target) override
+		bool Draw(sf::Time delta, Screen::CardBatch& batch) override
 		{
-			const bool res = VisibleCards::Draw(delta, target);
+			const bool res = VisibleCards::Draw(delta, batch);
 			if (_clear)
 			{
 				_cards.clear();
@@ -302,6 +327,7 @@ namespace
 				{
 					Animation animation;
 					animation.finalState.position = { -getCardSize().x, _view.getSize().y * 0.5f };
+					animation.easing = Easing::In;
 					animation.onFinish = [this]()
 						{
 							_clear = true;
@@ -384,33 +410,37 @@ namespace
 
 		void ShowCard(const Card& cardInfo)
 		{
-			constexpr float deltaCoeff = 0.5f;
+			auto& visibleCard = _cards.at(cardInfo);
+			const auto& state = visibleCard.GetFinalState();
+
+			Animation animation;
+			animation.finalState.position = state.position + ShowCardOffset * _faceDirection;
+			animation.finalState.angleDegree = state.angleDegree;
+			animation.duration *= ShowCardDurationCoeff;
+			animation.easing = Easing::InOut;
+			animation.onStart = [&]()
+				{
+					visibleCard.SetOpen(true);
+				};
+			visibleCard.StartAnimation(animation);
+		}
 
+		// returns the card shown by ShowCard
+		void HideCard(const Card& cardInfo)
+		{
 			auto& visibleCard = _cards.at(cardInfo);
 			const auto& state = visibleCard.GetFinalState();
-			{
-				Animation animation;
-				animation.finalState.position = state.position + 200.f * _faceDirection;
-				animation.finalState.angleDegree = state.angleDegree;
-				animation.deltaPerFrame *= deltaCoeff;
-				animation.onStart = [&]()
-					{
-						visibleCard.SetOpen(true);
-					};
-				visibleCard.StartAnimation(animation);
-			}
 
-			{
-				Animation animation;
-				animation.finalState = state;
-				animation.deltaPerFrame *= deltaCoeff;
-				animation.onFinish = [&]()
-					{
-						visibleCard.SetOpen(IsOpen());
-						std::this_thread::sleep_for(std::chrono::seconds(1));
-					};
-				visibleCard.StartAnimation(animation);
-			}
+			Animation animation;
+			animation.finalState.position = state.position - ShowCardOffset * _faceDirection;
+			animation.finalState.angleDegree = state.angleDegree;
+			animation.duration *= ShowCardDurationCoeff;
+			animation.easing = Easing::InOut;
+			animation.onFinish = [&]()
+				{
+					visibleCard.SetOpen(IsOpen());
+				};
+			visibleCard.StartAnimation(animation);
 		}
 
 		const sf::Vector2f& GetPosition() const
@@ -477,7 +507,7 @@ namespace
 
 			State state;
 			state.position = actualOptions->start + actualOptions->dir * actualOptions->offset * static_cast<float>(i);
-			state.angleDegree = angleDegree({ 0.f, -1.f }, _faceDirection, 180.f); // TODO: rotating around wrong center
+			state.angleDegree = angleDegree({ 0.f, -1.f }, _faceDirection, 180.f);
 			return state;
 		}
 
@@ -525,12 +555,12 @@ namespace
 			return true;
 		}
 
-		std::optional<Card> Pick(const sf::Vector2f& cursor, float interactOffset = 0.f, const std::function<bool(const Card&)>& filter = {}) const override
+		std::optional<Card> Pick(const sf::Vector2f& cursor, float interactOffset = 0.f, const CardSet& playableCards = CardSet::All()) const override
 		{
 			for (auto iter = _cards.rbegin(); iter != _cards.rend(); ++iter)
 			{
 				const VisibleCard& visibleCard = *iter;
-				if ((!filter || filter(visibleCard.GetCardInfo())) && visibleCard.IsPointInside(cursor, interactOffset))
+				if (playableCards.Contains(visibleCard.GetCardInfo()) && visibleCard.IsPointInside(cursor, interactOffset))
 					return visibleCard.GetCardInfo();
 			}
 			return std::nullopt;
@@ -539,7 +569,7 @@ namespace
 		void Hover(const std::optional<Card>& cardInfo)
 		{
 			constexpr float offset = 25.f;
-			constexpr float animationCoeff = 0.5;
+			constexpr float animationCoeff = 0.5f;
 
 			const auto options = getDefaultStateOptions();
 			if (!options)
@@ -553,7 +583,7 @@ namespace
 				Animation animation;
 				animation.finalState = *defaultState;
 				animation.finalState.position += GetFaceDirection() * offset;
-				animation.deltaPerFrame *= animationCoeff;
+				animation.duration *= animationCoeff;
 
 				visibleCard.ResetAnimation();
 				visibleCard.StartAnimation(animation);
@@ -562,7 +592,7 @@ namespace
 			{
 				Animation animation;
 				animation.finalState = *getDefaultState(_cards.index_of(*_hoverCard), options);
-				animation.deltaPerFrame *= animationCoeff;
+				animation.duration *= animationCoeff;
 
 				auto& visibleCard = _cards.at(*_hoverCard);
 				visibleCard.ResetAnimation();
@@ -619,14 +649,22 @@ namespace
 			return *_players[id];
 		}
 
-		bool Draw(sf::Time delta, sf::RenderTarget& target)
+		bool Draw(sf::Time delta, Screen::CardBatch& batch)
 		{
 			bool res = true;
 			for (auto& player : _players)
-				res = player->Draw(delta, target) && res;
+				res = player->Draw(delta, batch) && res;
 			return res;
 		}
 
+		size_t GetAnimationsCount() const
+		{
+			size_t count = 0;
+			for (const auto& player : _players)
+				count += player->GetAnimationsCount();
+			return count;
+		}
+
 	private:
 		using Index = Player::Id;
 		std::vector<std::unique_ptr<PlayerCards>> _players;
@@ -651,12 +689,10 @@ namespace
 		};
 
 		using PlayerCardsGetter = std::function<PlayerCards&()>;
-		using Filter = IController::PickCardFilter;
-
-		CardPick(const PlayerCardsGetter& playerCardsGetter, Options::Flags flags, const Filter& filter)
+		CardPick(const PlayerCardsGetter& playerCardsGetter, Options::Flags flags, const CardSet& playableCards)
 			: _playerCardsGetter(playerCardsGetter)
 			, _flags(flags)
-			, _filter(filter)
+			, _playableCards(playableCards)
 		{
 		}
 
@@ -679,7 +715,7 @@ namespace
 			}
 
 			PlayerCards& userCards = _playerCardsGetter();
-			if (auto pick = userCards.Pick(cursor, InteractOffset, _filter))
+			if (auto pick = userCards.Pick(cursor, InteractOffset, _playableCards))
 			{
 				_result.emplace(std::move(pick));
 				hovered = true;
@@ -706,7 +742,7 @@ namespace
 	private:
 		PlayerCardsGetter _playerCardsGetter;
 		Options::Flags _flags = Options::Flags::None;
-		Filter _filter;
+		CardSet _playableCards;
 		std::optional<Result> _result;
 	};
 
@@ -716,7 +752,7 @@ namespace
 		bool Hover(sf::RenderTarget& target, const sf::Vector2f& cursor) override
 		{
 			constexpr float spacing = Screen::Text::CharacterSize * 2.f;
-			constexpr size_t textCount = 2; /*static_cast<size_t>(Difficulty::Count);*/ // TODO
+			constexpr size_t textCount = static_cast<size_t>(Settings::Difficulty::Count);
 			const auto size = target.getView().getSize();
 
 			bool hovered = false;
@@ -741,7 +777,7 @@ namespace
 			size_t index = 0;
 			hovered = createText("easy", Settings::Difficulty::Easy, index++) || hovered;
 			hovered = createText("medium", Settings::Difficulty::Medium, index++) || hovered;
-			// hovered = createText("hard", Settings::Difficulty::Hard, index++) || hovered; // TODO
+			hovered = createText("hard", Settings::Difficulty::Hard, index++) || hovered;
 			return hovered;
 		}
 
@@ -772,10 +808,9 @@ struct UI::Data
 		enum Value : int
 		{
 			Default			= 0,
-			NeedRedraw		= 1 << 0,
-			HideCards		= 1 << 1,
-			UserVictory		= 1 << 2,
-			UserDefeat		= 1 << 3,
+			HideCards		= 1 << 0,
+			UserVictory		= 1 << 1,
+			UserDefeat		= 1 << 2,
 		};
 	};
 
@@ -788,18 +823,38 @@ struct UI::Data
 	{
 		Players playerCards;
 		RoundCards roundCards;
+		Player::Id user;
+		size_t deckCount;
+		std::optional<Card> trumpCard;
+		float speed; // of the animations
 
-		Game(const sf::View& view, size_t botsNumber)
+		Game(const sf::View& view, size_t botsNumber, Player::Id user, size_t deckCount, const std::optional<Card>& trumpCard, float speed)
 			: playerCards(view, botsNumber)
 			, roundCards(view)
+			, user(user)
+			, deckCount(deckCount)
+			, trumpCard(trumpCard)
+			, speed(speed)
 		{}
 	};
 
+	// keeps the last event on the screen before the next one is played
+	struct Pause
+	{
+		std::chrono::milliseconds duration;
+		std::function<void()> onFinish;
+		std::optional<std::chrono::steady_clock::time_point> until; // counted from the end of the animations
+	};
+
 	std::unique_ptr<Game> game;
 	std::underlying_type_t<Flag::Value> flags = Flag::Default;
 	sf::Vector2f cursorPosition;
 	std::shared_ptr<UserPick> userPick;
+	std::function<void()> onPick;
 	std::optional<Arrow> arrow;
+	std::optional<Pause> pause;
+	bool animating = false;
+	Screen::CardBatch cards; // reused every frame
 };
 
 UI::UI(const std::string& title, unsigned int width, unsigned int height)
@@ -821,196 +876,198 @@ const sf::RenderWindow& UI::GetWindow() const
 	return _window;
 }
 
-bool UI::NeedsToUpdate() const
-{
-	return _data && _data->flags & Data::Flag::NeedRedraw;
-}
-
 bool UI::HandleEvent(const sf::Event& event)
 {
-	auto guard = lockMutex();
-
-	if (!_data)
-		return false;
-
-	switch (event.type)
-	{
-	case sf::Event::EventType::MouseButtonPressed:
-		if (_data->userPick && _data->userPick->HasResult())
-		{
-			_data->userPick.reset();
-			_data->flags &= ~Data::Flag::NeedRedraw;
-		}
-		break;
-
-	case sf::Event::EventType::MouseMoved:
-		_data->cursorPosition = toModel({ event.mouseMove.x, event.mouseMove.y });
-		if (_data->userPick)
-			_data->flags |= Data::Flag::NeedRedraw;
-		break;
-	}
-
-	return false;
+	const bool pushed = _inputs.try_push(event);
+	Wake();
+	return pushed;
 }
 
 void UI::CloseWindow()
 {
-	auto guard = lockMutex();
 	_window.close();
 }
 
-void UI::Pick(const Context& context, std::shared_ptr<UserPick> userPick)
+void UI::Update()
 {
-	if (!_data)
+	bool changed = std::exchange(_redraw, false);
+	while (const auto input = _inputs.try_pop())
+	{
+		handleEvent(*input);
+		changed = true;
+	}
+
+	changed = applyEvents() || changed;
+	changed = changed || (_data && _data->animating);
+	if (!changed)
+	{
+		// nothing moves, sleeps until the game or the user does something
+		waitForChanges();
+		_profiler.Pause();
+		_clock.restart();
+		_redraw = std::chrono::steady_clock::now() >= _lastFrame + IdleRedrawPeriod;
 		return;
+	}
 
-	_data->userPick = userPick;
-	while (_data->userPick)
-		animate(context);
-}
+	if (!_window.isOpen())
+		return;
 
-std::optional<Card> UI::UserPickCard(const Context& context, bool attacking, const PickCardFilter& filter)
-{
-	if (!_data)
-		return std::nullopt;
+	const sf::Time delta = _clock.restart();
+	_window.clear();
+	const bool finished = update(delta);
+	_window.display();
+	_profiler.Present();
+	_lastFrame = std::chrono::steady_clock::now();
 
-	std::underlying_type_t<CardPick::Options::Flags> flags = CardPick::Options::Flags::None;
+	if (_data)
+		_data->animating = !finished;
 
-	if (attacking)
-		flags |= CardPick::Options::Flags::Attacking;
-	if (!attacking || !_data->game->roundCards.IsEmpty())
-		flags |= CardPick::Options::Flags::Skippable;
+	if (!_focused)
+		std::this_thread::sleep_for(UnfocusedFramePeriod);
+}
 
-	auto userPick = std::make_shared<CardPick>([this, &context]() -> PlayerCards&
-		{
-			return _data->game->playerCards.GetCards(context.GetPlayers().GetUser()->GetId());
-		}, static_cast<CardPick::Options::Flags>(flags), filter);
+void UI::Wake()
+{
+	{
+		std::lock_guard lock(_wakeMutex);
+		_awake = true;
+	}
+	_wakeCondition.notify_one();
+}
 
-	Pick(context, userPick);
+std::optional<Card> UI::UserPickCard(const Context& context, bool attacking, const CardSet& playableCards)
+{
+	std::promise<std::optional<Card>> pickedCard;
+	auto card = pickedCard.get_future();
 
-	std::optional<Card> card;
-	if (userPick->GetResult())
-		card = userPick->GetResult()->card;
+	Event event;
+	event.type = Event::Type::PickCard;
+	event.attacking = attacking;
+	event.cards = playableCards;
+	event.pickedCard = &pickedCard;
+	post(context, event);
 
-	return card;
+	return card.get();
 }
 
 void UI::SetSettings(const Context& context, Settings& settings)
 {
-	if (!_data)
-		return;
+	std::promise<Settings::Difficulty> pickedDifficulty;
+	auto difficulty = pickedDifficulty.get_future();
 
-	auto userPick = std::make_shared<DifficultyPick>();
-	_data->flags |= Data::Flag::HideCards;
-	Pick(context, userPick);
-	_data->flags &= ~Data::Flag::HideCards;
+	Event event;
+	event.type = Event::Type::PickDifficulty;
+	event.pickedDifficulty = &pickedDifficulty;
+	post(context, event);
 
-	if (userPick->GetResult())
-		settings.difficulty = userPick->GetResult().value();
+	settings.difficulty = difficulty.get();
+}
+
+void UI::Wait(const Context& context, std::chrono::steady_clock::time_point until)
+{
+	// the delay is played back after the events posted before it, the game goes on meanwhile
+	Event event;
+	event.type = Event::Type::Wait;
+	event.duration = std::chrono::ceil<std::chrono::milliseconds>(until - std::chrono::steady_clock::now());
+	post(context, event);
 }
 
 void UI::OnPlayerAttack(const Context& context, const Player& attacker, const Card& attackCard)
 {
-	onPlayerPlaceCard(context, attacker, attackCard);
+	Event event;
+	event.type = Event::Type::PlayerAttack;
+	event.player = attacker.GetId();
+	event.cards = CardSet::Of(attackCard);
+	post(context, event);
 }
 
 void UI::OnPlayerDefend(const Context& context, const Player& defender, const Card& defendCard)
 {
-	onPlayerPlaceCard(context, defender, defendCard);
+	Event event;
+	event.type = Event::Type::PlayerDefend;
+	event.player = defender.GetId();
+	event.cards = CardSet::Of(defendCard);
+	post(context, event);
 }
 
-void UI::OnPlayerDrawDeckCards(const Context& context, const Player& player, const std::vector<Card>& cards)
+void UI::OnPlayerDrawDeckCards(const Context& context, const Player& player, const CardSet& cards)
 {
-	if (!_data || !_data->game)
-		return;
-
-	PlayerCards& playerCards = _data->game->playerCards.GetCards(player.GetId());
-	const sf::Vector2f startPosition = getDeckPosition();
-	for (const Card& cardInfo : cards)
-	{
-		playerCards.Add(VisibleCard(cardInfo, State{ startPosition, 0.f }));
-	}
-	animate(context);
+	Event event;
+	event.type = Event::Type::PlayerDrawDeckCards;
+	event.player = player.GetId();
+	event.deckCount = static_cast<uint8_t>(context.GetDeck().GetCount());
+	event.cards = cards;
+	post(context, event);
 }
 
-void UI::OnPlayerDrawRoundCards(const Context& context, const Player& player, const std::vector<Card>& cards)
+void UI::OnPlayerDrawRoundCards(const Context& context, const Player& player, const CardSet& cards)
 {
-	if (!_data || !_data->game)
-		return;
-
-	PlayerCards& playerCards = _data->game->playerCards.GetCards(player.GetId());
-	for (const auto& cardInfo : cards)
-	{
-		playerCards.MoveFrom(cardInfo, _data->game->roundCards);
-	}
-	animate(context);
+	Event event;
+	event.type = Event::Type::PlayerDrawRoundCards;
+	event.player = player.GetId();
+	event.cards = cards;
+	post(context, event);
 }
 
 void UI::OnRoundStart(const Context& context, const Round& round)
 {
-	if (!_data || !_data->game)
-		return;
-
-	const auto& attackerCards = _data->game->playerCards.GetCards(round.GetAttacker().GetId());
-	const auto& defenderCards = _data->game->playerCards.GetCards(round.GetDefender().GetId());
-	sf::Vector2f dir = defenderCards.GetPosition() - attackerCards.GetPosition();
-	dir /= length(dir);
-	_data->arrow.emplace(dir);
-
-	animate(context);
-	std::this_thread::sleep_for(std::chrono::seconds(1));
-	_data->arrow.reset();
+	Event event;
+	event.type = Event::Type::RoundStart;
+	event.player = round.GetAttacker().GetId();
+	event.other = round.GetDefender().GetId();
+	event.duration = context.GetPacer().GetPauseDelay();
+	post(context, event);
 }
 
 void UI::OnRoundEnd(const Context& context, const Round& round)
 {
-	if (!_data || !_data->game)
-		return;
-
-	_data->game->roundCards.RemoveAll();
-	animate(context);
+	Event event;
+	event.type = Event::Type::RoundEnd;
+	post(context, event);
 }
 
 void UI::OnPlayersCreated(const Context& context, const PlayersGroup& players)
 {
-	if (!_data)
-		return;
-
-	_data->game = std::make_unique<Data::Game>(_window.getView(), players.GetCount() - 1);
-	animate(context);
+	Event event;
+	event.type = Event::Type::PlayersCreated;
+	if (const Player* user = players.GetUser())
+		event.player = user->GetId();
+	event.playersCount = static_cast<uint8_t>(players.GetCount());
+	event.deckCount = static_cast<uint8_t>(context.GetDeck().GetCount());
+	if (const auto trumpCard = context.GetDeck().GetLast())
+		event.cards = CardSet::Of(*trumpCard);
+	post(context, event);
 }
 
 void UI::OnPlayerShowTrumpCard(const Context& context, const Player& player, const Card& card)
 {
-	if (!_data || !_data->game)
-		return;
-
-	auto& playerCards = _data->game->playerCards.GetCards(player.GetId());
-	playerCards.ShowCard(card);
-	animate(context);
+	Event event;
+	event.type = Event::Type::PlayerShowTrumpCard;
+	event.player = player.GetId();
+	event.cards = CardSet::Of(card);
+	event.duration = context.GetPacer().GetPauseDelay();
+	post(context, event);
 }
 
 void UI::OnStartGame(const Context& context)
 {
-	_data = std::make_unique<Data>();
+	Event event;
+	event.type = Event::Type::StartGame;
+	post(context, event);
 }
 
 void UI::OnUserWin(const Context& context, const Player& user)
 {
-	if (!_data)
-		return;
-
-	_data->flags |= Data::Flag::UserVictory;
-	animate(context);
+	Event event;
+	event.type = Event::Type::UserWin;
+	post(context, event);
 }
 
 void UI::OnUserLose(const Context& context, const Player& opponent)
 {
-	if (!_data || !_data->game)
-		return;
-
-	_data->flags |= Data::Flag::UserDefeat;
-	animate(context);
+	Event event;
+	event.type = Event::Type::UserLose;
+	post(context, event);
 }
 
 sf::Vector2f UI::toModel(const sf::Vector2i& screen) const
@@ -1023,49 +1080,258 @@ sf::Vector2i UI::toScreen(const sf::Vector2f& model) const
 	return _window.mapCoordsToPixel(model);
 }
 
-void UI::onPlayerPlaceCard(const Context& context, const Player& player, const Card& card)
+void UI::post(const Context& context, Event event)
+{
+	event.speed = context.GetPacer().GetSpeed();
+	_events.push(event);
+	Wake();
+}
+
+void UI::handleEvent(const sf::Event& event)
 {
-	if (!_data || !_data->game)
+	if (event.type == sf::Event::EventType::LostFocus || event.type == sf::Event::EventType::GainedFocus)
+		_focused = event.type == sf::Event::EventType::GainedFocus;
+
+	if (event.type == sf::Event::EventType::KeyPressed && event.key.code == ProfilerKey)
+		_profiler.Toggle();
+
+	if (!_data)
 		return;
 
-	_data->game->roundCards.MoveFrom(card, _data->game->playerCards.GetCards(player.GetId()));
-	animate(context);
+	switch (event.type)
+	{
+	case sf::Event::EventType::MouseButtonPressed:
+		if (_data->userPick && _data->userPick->HasResult())
+		{
+			const auto onPick = std::move(_data->onPick);
+			onPick();
+			_data->userPick.reset();
+		}
+		break;
+
+	case sf::Event::EventType::MouseMoved:
+		_data->cursorPosition = toModel({ event.mouseMove.x, event.mouseMove.y });
+		break;
+	}
 }
 
-sf::Vector2f UI::getDeckPosition() const
+bool UI::applyEvents()
 {
-	const auto size = _window.getView().getSize();
-	return { 0.9f * size.x, 0.5f * size.y };
+	// an event is played once the animations of the previous one are over, at most one per frame
+	if (_data && (_data->animating || _data->userPick))
+		return false;
+
+	if (_data && _data->pause)
+	{
+		auto& pause = *_data->pause;
+		const auto now = std::chrono::steady_clock::now();
+		if (!pause.until)
+			pause.until = now + pause.duration;
+		if (now < *pause.until)
+			return false;
+
+		const auto onFinish = std::move(pause.onFinish);
+		_data->pause.reset();
+		if (onFinish)
+		{
+			onFinish();
+			return true;
+		}
+	}
+
+	const auto event = _events.try_pop();
+	if (event)
+		apply(*event);
+	return event.has_value();
+}
+
+void UI::waitForChanges()
+{
+	// the end of a pause is a change too
+	auto until = std::chrono::steady_clock::now() + IdleRedrawPeriod;
+	if (_data && _data->pause && _data->pause->until)
+		until = std::min(until, *_data->pause->until);
+
+	std::unique_lock lock(_wakeMutex);
+	_wakeCondition.wait_until(lock, until, [this]() { return _awake; });
+	_awake = false;
 }
 
-void UI::animate(const Context& context)
+void UI::apply(const Event& event)
 {
+	if (event.type == Event::Type::StartGame)
+	{
+		_data = std::make_unique<Data>();
+		return;
+	}
+
 	if (!_data)
+	{
+		// nothing to show, the game thread mustn't wait for a pick forever
+		if (event.pickedCard)
+			event.pickedCard->set_value(std::nullopt);
+		if (event.pickedDifficulty)
+			event.pickedDifficulty->set_value(Settings{}.difficulty);
+		return;
+	}
+
+	Data::Game* game = _data->game.get();
+	const bool needsGame = event.type != Event::Type::PlayersCreated
+		&& event.type != Event::Type::PickDifficulty
+		&& event.type != Event::Type::Wait
+		&& event.type != Event::Type::UserWin;
+	if (needsGame && !game)
+	{
+		if (event.pickedCard)
+			event.pickedCard->set_value(std::nullopt);
 		return;
+	}
+
+	if (game)
+		game->speed = event.speed;
+
+	switch (event.type)
+	{
+	case Event::Type::PlayerAttack:
+	case Event::Type::PlayerDefend:
+		game->roundCards.MoveFrom(*event.cards.GetLowest(), game->playerCards.GetCards(event.player));
+		break;
+
+	case Event::Type::PlayerDrawDeckCards:
+	{
+		PlayerCards& playerCards = game->playerCards.GetCards(event.player);
+		const sf::Vector2f startPosition = getDeckPosition();
+		for (const Card& cardInfo : event.cards)
+		{
+			playerCards.Add(VisibleCard(cardInfo, State{ startPosition, 0.f }));
+		}
+		game->deckCount = event.deckCount;
+		break;
+	}
+
+	case Event::Type::PlayerDrawRoundCards:
+	{
+		PlayerCards& playerCards = game->playerCards.GetCards(event.player);
+		for (const auto& cardInfo : event.cards)
+		{
+			playerCards.MoveFrom(cardInfo, game->roundCards);
+		}
+		break;
+	}
+
+	case Event::Type::RoundStart:
+	{
+		const auto& attackerCards = game->playerCards.GetCards(event.player);
+		const auto& defenderCards = game->playerCards.GetCards(event.other);
+		sf::Vector2f dir = defenderCards.GetPosition() - attackerCards.GetPosition();
+		dir /= length(dir);
+		_data->arrow.emplace(dir);
+		_data->pause.emplace(event.duration, [this]()
+			{
+				_data->arrow.reset();
+			});
+		break;
+	}
+
+	case Event::Type::RoundEnd:
+		game->roundCards.RemoveAll();
+		break;
+
+	case Event::Type::PlayersCreated:
+		_data->game = std::make_unique<Data::Game>(_window.getView(), event.playersCount - 1, event.player, event.deckCount, event.cards.GetLowest(), event.speed);
+		break;
+
+	case Event::Type::PlayerShowTrumpCard:
+	{
+		const Card card = *event.cards.GetLowest();
+		game->playerCards.GetCards(event.player).ShowCard(card);
+		_data->pause.emplace(event.duration, [this, player = event.player, card]()
+			{
+				_data->game->playerCards.GetCards(player).HideCard(card);
+			});
+		break;
+	}
+
+	case Event::Type::UserWin:
+		_data->flags |= Data::Flag::UserVictory;
+		break;
+
+	case Event::Type::UserLose:
+		_data->flags |= Data::Flag::UserDefeat;
+		break;
+
+	case Event::Type::Wait:
+		_data->pause.emplace(event.duration);
+		break;
+
+	case Event::Type::PickCard:
+	{
+		std::underlying_type_t<CardPick::Options::Flags> flags = CardPick::Options::Flags::None;
+		if (event.attacking)
+			flags |= CardPick::Options::Flags::Attacking;
+		if (!event.attacking || !game->roundCards.IsEmpty())
+			flags |= CardPick::Options::Flags::Skippable;
+
+		auto userPick = std::make_shared<CardPick>([this, user = game->user]() -> PlayerCards&
+			{
+				return _data->game->playerCards.GetCards(user);
+			}, static_cast<CardPick::Options::Flags>(flags), event.cards);
+
+		pick(userPick, [userPick, pickedCard = event.pickedCard]()
+			{
+				std::optional<Card> card;
+				if (userPick->GetResult())
+					card = userPick->GetResult()->card;
+				pickedCard->set_value(card);
+			});
+		break;
+	}
 
-	sf::Clock clock;
-	_data->flags |= Data::Flag::NeedRedraw;
-	while (NeedsToUpdate())
+	case Event::Type::PickDifficulty:
 	{
-		_window.clear();
-		update(context, clock.restart());
-		_window.display();
+		auto userPick = std::make_shared<DifficultyPick>();
+		_data->flags |= Data::Flag::HideCards;
+		pick(userPick, [this, userPick, pickedDifficulty = event.pickedDifficulty]()
+			{
+				_data->flags &= ~Data::Flag::HideCards;
+				pickedDifficulty->set_value(userPick->GetResult().value_or(Settings{}.difficulty));
+			});
+		break;
+	}
 	}
 }
 
-void UI::update(const Context& context, sf::Time delta)
+void UI::pick(std::shared_ptr<UserPick> userPick, std::function<void()> onPick)
 {
-	auto guard = lockMutex();
+	_data->userPick = std::move(userPick);
+	_data->onPick = std::move(onPick);
+}
 
-	if (!NeedsToUpdate() || !_window.isOpen() || !_data)
-		return;
+sf::Vector2f UI::getDeckPosition() const
+{
+	const auto size = _window.getView().getSize();
+	return { 0.9f * size.x, 0.5f * size.y };
+}
+
+bool UI::update(sf::Time delta)
+{
+	if (!_data)
+		return true;
+
+	_profiler.BeginFrame();
+	Profiler::Counters counters;
+	const auto draw = [this, &counters](const sf::Drawable& drawable)
+		{
+			_window.draw(drawable);
+			++counters.drawings;
+		};
 
 	const auto size = _window.getView().getSize();
 	sf::Cursor::Type cursorType = sf::Cursor::Arrow;
 
 	{
-		Screen::Table table;
-		_window.draw(table);
+		Profiler::Scope scope(_profiler, Profiler::Section::Table);
+		draw(Screen::Table{});
 	}
 
 	bool finished = true;
@@ -1080,40 +1346,48 @@ void UI::update(const Context& context, sf::Time delta)
 	if (_data->game && !(_data->flags & Data::Flag::HideCards))
 	{
 		{
-			Screen::Deck deck(context.GetDeck());
+			Profiler::Scope scope(_profiler, Profiler::Section::Deck);
+			Screen::Deck deck(_data->game->deckCount, _data->game->trumpCard);
 			deck.setOrigin(getDeckPosition());
-			_window.draw(deck);
+			draw(deck);
 		}
 
 		if (_data->arrow)
 		{
 			Screen::Arrow arrow(_data->arrow->direction);
 			arrow.setOrigin(0.5f * size);
-			_window.draw(arrow);
+			draw(arrow);
 		}
 
-		finished = _data->game->playerCards.Draw(delta, _window) && finished;
-		finished = _data->game->roundCards.Draw(delta, _window) && finished;
+		const sf::Time animationDelta = getAnimationDelta(delta, _data->game->speed);
+		_data->cards.Clear();
+		{
+			Profiler::Scope scope(_profiler, Profiler::Section::Players);
+			finished = _data->game->playerCards.Draw(animationDelta, _data->cards) && finished;
+		}
+		{
+			Profiler::Scope scope(_profiler, Profiler::Section::RoundCards);
+			finished = _data->game->roundCards.Draw(animationDelta, _data->cards) && finished;
+		}
+		{
+			Profiler::Scope scope(_profiler, Profiler::Section::Batch);
+			draw(_data->cards);
+		}
 	}
 
 	if (_data->flags & Data::Flag::UserVictory)
 	{
 		Screen::Text text("victory");
 		text.setOrigin(0.5f * size);
-		_window.draw(text);
-		finished = false;
+		draw(text);
 	}
 	else if (_data->flags & Data::Flag::UserDefeat)
 	{
 		Screen::Text text("defeat");
 		text.setOrigin(0.5f * size);
-		_window.draw(text);
-		finished = false;
+		draw(text);
 	}
 
-	if (finished)
-		_data->flags &= ~Data::Flag::NeedRedraw;
-
 	if (_cursorType != cursorType)
 	{
 		_cursorType = cursorType;
@@ -1121,4 +1395,16 @@ void UI::update(const Context& context, sf::Time delta)
 		cursor.loadFromSystem(cursorType);
 		_window.setMouseCursor(cursor);
 	}
+
+	if (_profiler.IsEnabled())
+	{
+		counters.cards = _data->cards.GetCount();
+		if (_data->game)
+			counters.animations = _data->game->playerCards.GetAnimationsCount() + _data->game->roundCards.GetAnimationsCount();
+		counters.queuedEvents = _events.size();
+	}
+	_profiler.EndFrame(counters);
+	_profiler.Draw(_window);
+
+	return finished;
 }
\ No newline at end of file
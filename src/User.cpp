@@ -1,16 +1,16 @@
 #include "User.h"
 #include "Card.h"
 #include "Context.h"
-#include "UI.h"
+#include "IController.h"
 
-std::optional<Card> User::pickAttackCard(const Context& context, const Player& defender, const CardFilter& filter) const
+std::optional<Card> User::pickAttackCard(const Context& context, const Player& defender, const CardSet& playableCards) const
 {
-	auto ui = context.GetUI();
-	return ui ? ui->UserPickCard(context, true, filter) : std::nullopt;
+	auto controller = context.GetController();
+	return controller ? controller->UserPickCard(context, true, playableCards) : std::nullopt;
 }
 
-std::optional<Card> User::pickDefendCard(const Context& context, const Player& attacker, const CardFilter& filter) const
+std::optional<Card> User::pickDefendCard(const Context& context, const Player& attacker, const CardSet& playableCards) const
 {
-	auto ui = context.GetUI();
-	return ui ? ui->UserPickCard(context, false, filter) : std::nullopt;
+	auto controller = context.GetController();
+	return controller ? controller->UserPickCard(context, false, playableCards) : std::nullopt;
 }
\ No newline at end of file